@@ -0,0 +1,41 @@
+#include <iostream>
+#include <fstream>
+
+#include "Log.h"
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage: log-decode <file.binlog>..." << std::endl;
+
+		return 1;
+	}
+
+	std::ios_base::sync_with_stdio(false);
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::ifstream input(argv[i], std::ios::binary);
+
+		if (!input.is_open())
+		{
+			std::cerr << "Can't open " << argv[i] << std::endl;
+
+			return 1;
+		}
+
+		try
+		{
+			Log::decodeBinaryLog(input, std::cout);
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << argv[i] << ": " << e.what() << std::endl;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
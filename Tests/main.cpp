@@ -1,4 +1,16 @@
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <thread>
 
 #include "gtest/gtest.h"
 
@@ -6,6 +18,31 @@
 
 using namespace std::string_literals;
 
+// Only allocations of test thread, background threads of other loggers allocate at any time
+static thread_local size_t allocationsCount = 0;
+
+void* operator new(size_t size)
+{
+	allocationsCount++;
+
+	if (void* result = std::malloc(size ? size : 1))
+	{
+		return result;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	std::free(pointer);
+}
+
 TEST(Log, Configuration)
 {
 	Log::configure(Log::DateFormat::DMY);
@@ -40,6 +77,45 @@ TEST(Log, Logging)
 	ASSERT_NO_THROW(Log::error("Log int", "LogError", 5));
 }
 
+// Median time of logging call that rotates log file
+static std::chrono::steady_clock::duration measureRotation(bool prepareNextLogFile)
+{
+	static constexpr size_t rotations = 21;
+
+	Log::Settings settings;
+	std::vector<std::chrono::steady_clock::duration> rotationTimes;
+
+	settings.pathToLogs = std::filesystem::current_path() / (prepareNextLogFile ? "rotation-prepared-logs" : "rotation-logs");
+	settings.logFileSize = 256 * 1024;
+	settings.prepareNextLogFile = prepareNextLogFile;
+
+	{
+		Log::Logger logger(settings);
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+
+		for (size_t i = 0; rotationTimes.size() < rotations; i++)
+		{
+			auto messageStart = std::chrono::steady_clock::now();
+
+			logger.info("Rotation message with current index {}", "LogTest", i);
+
+			auto messageTime = std::chrono::steady_clock::now() - messageStart;
+
+			if (std::filesystem::path logFile = logger.getCurrentLogFilePath(); logFile != currentLogFile)
+			{
+				rotationTimes.push_back(messageTime);
+				currentLogFile = std::move(logFile);
+			}
+		}
+	}
+
+	std::filesystem::remove_all(settings.pathToLogs);
+
+	std::ranges::sort(rotationTimes);
+
+	return rotationTimes[rotations / 2];
+}
+
 TEST(Log, ChangingLogFile)
 {
 	static constexpr size_t cycles = 2'500'000;
@@ -61,9 +137,79 @@ TEST(Log, ChangingLogFile)
 
 	std::cout << resultSeconds << " seconds" << std::endl;
 	std::cout << resultSeconds / cycles << " seconds per message" << std::endl;
+	std::cout << cycles / resultSeconds << " messages per second" << std::endl;
 #endif
 
 	ASSERT_NE(Log::getCurrentLogFilePath(), currentLogFile);
+
+	std::chrono::steady_clock::duration synchronousRotation = measureRotation(false);
+	std::chrono::steady_clock::duration preparedRotation = measureRotation(true);
+
+	std::cout << std::chrono::duration_cast<std::chrono::microseconds>(synchronousRotation).count() << " microseconds per rotation" << std::endl;
+	std::cout << std::chrono::duration_cast<std::chrono::microseconds>(preparedRotation).count() << " microseconds per prepared rotation" << std::endl;
+
+	// Prepared rotation only swaps file handles, creating and opening file happens on other core
+	if (std::thread::hardware_concurrency() > 1)
+	{
+		ASSERT_LT(preparedRotation, synchronousRotation);
+	}
+}
+
+TEST(Log, PreparedLogFile)
+{
+	std::filesystem::path preparedPath = std::filesystem::current_path() / "prepared-logs";
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = preparedPath;
+		settings.logFileSize = 4096;
+		settings.prepareNextLogFile = true;
+		settings.preallocateLogFiles = true;
+
+		Log::Logger logger(settings);
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+		std::filesystem::path preparedLogFile;
+
+		logger.info("First prepared message", "LogInformation");
+
+		// Next log file is created on background thread ahead of rotation
+		for (size_t i = 0; i < 500 && preparedLogFile.empty(); i++)
+		{
+			for (const auto& entry : std::filesystem::directory_iterator(currentLogFile.parent_path()))
+			{
+				if (entry.path() != currentLogFile)
+				{
+					preparedLogFile = entry.path();
+				}
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		ASSERT_FALSE(preparedLogFile.empty());
+
+		for (size_t i = 0; logger.getCurrentLogFilePath() == currentLogFile; i++)
+		{
+			logger.info("Prepared message {}", "LogInformation", i);
+		}
+
+		ASSERT_EQ(logger.getCurrentLogFilePath(), preparedLogFile);
+
+		logger.info("Last prepared message", "LogInformation");
+	}
+
+	// Unused prepared log file is removed, used ones keep only written data
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(preparedPath))
+	{
+		if (entry.is_regular_file())
+		{
+			ASSERT_GT(entry.file_size(), 0);
+			ASSERT_LE(entry.file_size(), 4096);
+		}
+	}
+
+	std::filesystem::remove_all(preparedPath);
 }
 
 TEST(Log, DebugLogging)
@@ -114,6 +260,1356 @@ TEST(Log, VerbosityLogging)
 	ASSERT_NE(temp.find("LogError: This info message should be logged"), std::string::npos);
 }
 
+TEST(Log, CategoryVerbosityLogging)
+{
+	Log::setVerbosityLevel(Log::VerbosityLevel::warning);
+	Log::setVerbosityLevel("Net", Log::VerbosityLevel::error);
+	Log::setVerbosityLevel("DB", Log::VerbosityLevel::verbose);
+
+	Log::warning("Net warning message should not be logged", "Net");
+	Log::error("Net error message should be logged", "Net");
+	LOG_WARNING("Net macro warning message should not be logged", "Net");
+	LOG_ERROR("Net macro error message {} should be logged", "Net", 1);
+	Log::info("DB info message should be logged", "DB");
+	Log::info("Other info message should not be logged", "Other");
+
+	Log::resetVerbosityLevel("DB");
+
+	Log::info("Reset DB info message should not be logged", "DB");
+
+	// Logged categories don't use ids of category levels
+	for (size_t i = 0; i < 300; i++)
+	{
+		Log::warning("Runtime category message", std::format("Runtime{}", i));
+	}
+
+	ASSERT_NO_THROW(Log::setVerbosityLevel("Runtime299", Log::VerbosityLevel::error));
+
+	Log::warning("Runtime warning message should not be logged", "Runtime299");
+
+	// Cached category without level gets level set later
+	for (const char* message : { "Late warning message should be logged", "Late warning message should not be logged" })
+	{
+		Log::warning(message, "Late");
+		Log::setVerbosityLevel("Late", Log::VerbosityLevel::error);
+	}
+
+	// Call site category gets its id before level is set
+	static const Log::CategorySite cacheCategory("Cache");
+
+	for (const char* message : { "Cache warning message should be logged", "Cache warning message should not be logged" })
+	{
+		Log::warning(message, cacheCategory);
+		Log::setVerbosityLevel("Cache", Log::VerbosityLevel::error);
+	}
+
+	Log::resetVerbosityLevel("Cache");
+	Log::resetVerbosityLevel("Late");
+	Log::resetVerbosityLevel("Runtime299");
+	Log::resetVerbosityLevel("Net");
+	Log::setVerbosityLevel(Log::VerbosityLevel::verbose);
+
+	std::ifstream in(Log::getCurrentLogFilePath());
+	std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+	ASSERT_EQ(temp.find("Net warning message should not be logged"), std::string::npos);
+	ASSERT_NE(temp.find("Net error message should be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Net macro warning message should not be logged"), std::string::npos);
+	ASSERT_NE(temp.find("Net macro error message 1 should be logged"), std::string::npos);
+	ASSERT_NE(temp.find("DB info message should be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Other info message should not be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Reset DB info message should not be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Runtime warning message should not be logged"), std::string::npos);
+	ASSERT_NE(temp.find("Late warning message should be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Late warning message should not be logged"), std::string::npos);
+	ASSERT_NE(temp.find("Cache warning message should be logged"), std::string::npos);
+	ASSERT_EQ(temp.find("Cache warning message should not be logged"), std::string::npos);
+}
+
+TEST(Log, SampledLogging)
+{
+	for (int i = 0; i < 10; i++)
+	{
+		LOG_INFO_EVERY(4, "Sampled message {}", "LogInformation", i);
+		LOG_WARNING_LIMITED(2, std::chrono::hours(1), "Limited message", "LogWarning");
+		LOG_ERROR_LIMITED(3, std::chrono::seconds(1), "Storm message", "LogError");
+	}
+
+	std::string temp;
+
+	// Summary is written when period of call site ends
+	for (size_t i = 0; i < 300 && temp.find("Suppressed 7 similar messages") == std::string::npos; i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+		std::ifstream in(Log::getCurrentLogFilePath());
+
+		temp = (std::ostringstream() << in.rdbuf()).str();
+	}
+
+	size_t limited = 0;
+
+	for (size_t position = temp.find("Limited message"); position != std::string::npos; position = temp.find("Limited message", position + 1))
+	{
+		limited++;
+	}
+
+	ASSERT_NE(temp.find("Sampled message 0"), std::string::npos);
+	ASSERT_EQ(temp.find("Sampled message 1"), std::string::npos);
+	ASSERT_NE(temp.find("Sampled message 4"), std::string::npos);
+	ASSERT_NE(temp.find("Sampled message 8"), std::string::npos);
+	ASSERT_EQ(limited, 2);
+	ASSERT_NE(temp.find("LogError: ERROR: Suppressed 7 similar messages"), std::string::npos);
+}
+
+TEST(Log, RuntimeFormatLogging)
+{
+	std::string format = "Runtime format message {}";
+	std::string_view formatView = "Runtime format view message {}";
+	const char* formatPointer = "Runtime format pointer message {}";
+
+	Log::info(format, "LogInformation", 1);
+	Log::warning(formatView, "LogWarning", 2);
+	Log::error(formatPointer, "LogError", 3);
+
+	ASSERT_THROW(Log::info(std::string("Wrong runtime format {"), "LogInformation", 4), std::format_error);
+
+	std::ifstream in(Log::getCurrentLogFilePath());
+	std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+	ASSERT_NE(temp.find("Runtime format message 1"), std::string::npos);
+	ASSERT_NE(temp.find("Runtime format view message 2"), std::string::npos);
+	ASSERT_NE(temp.find("Runtime format pointer message 3"), std::string::npos);
+}
+
+TEST(Log, FieldLogging)
+{
+	std::string path = "/index.html";
+
+	Log::info("Request {} done with {:04}", "LogInformation", Log::field("path", path), Log::field("status", 200), Log::field("elapsed", 1.5));
+
+	std::ifstream in(Log::getCurrentLogFilePath());
+	std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+	ASSERT_NE(temp.find("Request /index.html done with 0200"), std::string::npos);
+}
+
+TEST(Log, IndependentLoggers)
+{
+	std::filesystem::path accessPath = std::filesystem::current_path() / "access-logs";
+	std::filesystem::path auditPath = std::filesystem::current_path() / "audit-logs";
+
+	{
+		Log::Settings accessSettings;
+		Log::Settings auditSettings;
+
+		accessSettings.pathToLogs = accessPath;
+		accessSettings.logFileSize = 1024;
+		accessSettings.writeMode = Log::WriteMode::asynchronous;
+
+		auditSettings.pathToLogs = auditPath;
+		auditSettings.flags = Log::AdditionalInformation::processId;
+		auditSettings.verbosityLevel = Log::VerbosityLevel::warning;
+		auditSettings.writeMode = Log::WriteMode::asynchronous;
+		auditSettings.jsonLog = true;
+
+		Log::Logger access(accessSettings);
+		Log::Logger audit(auditSettings);
+
+		// Only default logger sets public log file size
+		ASSERT_EQ(Log::logFileSize, 128 * 1024 * 1024);
+
+		for (int i = 0; i < 100; i++)
+		{
+			access.info("Access message {}", "Access", i);
+		}
+
+		audit.info("Audit info message should not be logged", "Audit");
+		audit.warning("Audit \"warning\" message", "Audit", Log::field("user", "admin"), Log::field("attempts", 3));
+
+		access.flush();
+		audit.flush();
+
+		std::ifstream in(audit.getCurrentLogFilePath());
+		std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+		ASSERT_EQ(temp, std::format("{{\"pid\":{},\"category\":\"Audit\",\"level\":\"WARNING\",\"message\":\"Audit \\\"warning\\\" message\",\"user\":\"admin\",\"attempts\":3}}\n", Log::getExecutableProcessId()));
+		ASSERT_NE(access.getCurrentLogFilePath().parent_path().parent_path(), Log::getCurrentLogFilePath().parent_path().parent_path());
+		ASSERT_THROW(Log::Logger duplicate(accessSettings), std::runtime_error);
+
+		Log::Settings defaultSettings;
+
+		// Empty path is current_path/logs of default logger, static functions keep writing there
+		ASSERT_THROW(Log::Logger defaultPath(defaultSettings), std::runtime_error);
+
+		Log::info("Default logger message after independent loggers", "LogInformation");
+
+		std::ifstream defaultIn(Log::getCurrentLogFilePath());
+
+		ASSERT_NE((std::ostringstream() << defaultIn.rdbuf()).str().find("Default logger message after independent loggers"), std::string::npos);
+	}
+
+	size_t accessLogFiles = 0;
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(accessPath))
+	{
+		accessLogFiles += entry.is_regular_file();
+	}
+
+	ASSERT_GT(accessLogFiles, 1);
+
+	std::filesystem::remove_all(accessPath);
+	std::filesystem::remove_all(auditPath);
+}
+
+static std::string escapeJson(std::string_view text)
+{
+	std::string result;
+
+	for (char value : text)
+	{
+		switch (value)
+		{
+		case '"':
+			result += "\\\"";
+
+			break;
+
+		case '\\':
+			result += "\\\\";
+
+			break;
+
+		case '\b':
+			result += "\\b";
+
+			break;
+
+		case '\f':
+			result += "\\f";
+
+			break;
+
+		case '\n':
+			result += "\\n";
+
+			break;
+
+		case '\r':
+			result += "\\r";
+
+			break;
+
+		case '\t':
+			result += "\\t";
+
+			break;
+
+		default:
+			if (static_cast<unsigned char>(value) < 0x20)
+			{
+				result += std::format("\\u{:04x}", static_cast<int>(value));
+			}
+			else
+			{
+				result += value;
+			}
+
+			break;
+		}
+	}
+
+	return result;
+}
+
+TEST(Log, JsonLogging)
+{
+	std::filesystem::path jsonPath = std::filesystem::current_path() / "json-logs";
+	std::vector<std::string> texts;
+
+	// Lengths around SSE2 and AVX2 chunks, escaped character at start, middle and in overlapping last chunk
+	for (size_t length : { 0, 15, 16, 17, 31, 32, 33 })
+	{
+		texts.emplace_back(length, 'a');
+
+		for (size_t position : { size_t(0), length / 2, length - 1 })
+		{
+			if (position < length)
+			{
+				for (char escaped : { '"', '\\', '\n', '\x01' })
+				{
+					std::string& text = texts.emplace_back(length, 'a');
+
+					text[position] = escaped;
+				}
+			}
+		}
+	}
+
+	texts.emplace_back("Control characters \x00\x01\x07\b\t\n\x0b\f\r\x1b\x1f end"s);
+	texts.emplace_back("UTF-8 \xc3\xa9\xe2\x82\xac and bytes \x7f\x80\xff stay as they are");
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = jsonPath;
+		settings.flags = Log::AdditionalInformation::utcDate | Log::AdditionalInformation::localDate | Log::AdditionalInformation::threadId;
+		settings.threadIdFormat = Log::ThreadIdFormat::system;
+		settings.jsonLog = true;
+
+		Log::Logger logger(settings);
+
+		// Message escapes formatted text in place, field appends escaped value
+		for (const std::string& text : texts)
+		{
+			logger.info("{}", "Json", Log::field("text", text));
+		}
+
+		logger.flush();
+
+		std::ifstream in(logger.getCurrentLogFilePath());
+		std::regex prefix(R"(\{"utc":"\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}Z","local":"\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}\.\d{3}[+-]\d{2}:\d{2}","tid":\d+,)");
+		size_t index = 0;
+
+		for (std::string line; std::getline(in, line); index++)
+		{
+			std::smatch match;
+
+			ASSERT_LT(index, texts.size());
+			ASSERT_TRUE(std::regex_search(line, match, prefix, std::regex_constants::match_continuous)) << line;
+
+			std::string escaped = escapeJson(texts[index]);
+
+			ASSERT_EQ(match.suffix().str(), std::format("\"category\":\"Json\",\"level\":\"INFO\",\"message\":\"{}\",\"text\":\"{}\"}}", escaped, escaped));
+		}
+
+		ASSERT_EQ(index, texts.size());
+		ASSERT_EQ(escapeJson(texts[texts.size() - 2]), R"(Control characters \u0000\u0001\u0007\b\t\n\u000b\f\r\u001b\u001f end)");
+		ASSERT_EQ(escapeJson(texts.back()), texts.back());
+	}
+
+	std::filesystem::remove_all(jsonPath);
+}
+
+TEST(Log, AsynchronousLogging)
+{
+	static constexpr size_t records = 2000;
+
+	std::filesystem::path asynchronousPath = std::filesystem::current_path() / "asynchronous-logs";
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = asynchronousPath;
+		settings.logFileSize = 4096;
+		settings.writeMode = Log::WriteMode::asynchronous;
+
+		Log::Logger logger(settings);
+
+		logger.info("Flushed message", "LogInformation");
+		logger.flush();
+
+		{
+			std::ifstream in(logger.getCurrentLogFilePath());
+			std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+			ASSERT_NE(temp.find("Flushed message"), std::string::npos);
+		}
+
+		{
+			static constexpr size_t threadsCount = 4;
+
+			std::array<std::atomic<size_t>, threadsCount> written{};
+			std::atomic<size_t> missing = 0;
+			std::shared_ptr<Log::CallbackSink> callback = std::make_shared<Log::CallbackSink>([&written](std::string_view record, Log::VerbosityLevel level)
+				{
+					size_t thread = 0;
+					size_t index = 0;
+
+					if (std::sscanf(std::string(record.substr(record.find("Concurrent flush "))).data(), "Concurrent flush %zu %zu", &thread, &index) == 2)
+					{
+						written[thread].store(index + 1);
+					}
+				});
+			std::vector<std::thread> threads;
+
+			logger.addSink(callback);
+
+			// Flush returns only after own record is written even when other threads push at the same time
+			for (size_t thread = 0; thread < threadsCount; thread++)
+			{
+				threads.emplace_back([&logger, &written, &missing, thread]()
+					{
+						for (size_t i = 0; i < 500; i++)
+						{
+							logger.info("Concurrent flush {} {}", "LogInformation", thread, i);
+							logger.flush();
+
+							missing += written[thread].load() <= i;
+						}
+					});
+			}
+
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+
+			logger.removeSink(callback);
+
+			ASSERT_EQ(missing, 0);
+		}
+
+		for (size_t i = 0; i < records; i++)
+		{
+			logger.info("Asynchronous message {}", "LogInformation", i);
+
+			// Rotation happens on writer thread
+			ASSERT_FALSE(logger.getCurrentLogFilePath().empty());
+		}
+
+		// Destructor writes all queued records
+	}
+
+	std::vector<std::vector<size_t>> files;
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(asynchronousPath))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		std::ifstream in(entry.path());
+		std::vector<size_t> indices;
+		std::string line;
+
+		while (std::getline(in, line))
+		{
+			if (size_t position = line.find("Asynchronous message "); position != std::string::npos)
+			{
+				indices.push_back(std::stoull(line.substr(position + std::string_view("Asynchronous message ").size())));
+			}
+		}
+
+		if (indices.size())
+		{
+			files.push_back(std::move(indices));
+		}
+	}
+
+	std::ranges::sort(files, {}, [](const std::vector<size_t>& indices) { return indices.front(); });
+
+	size_t expected = 0;
+
+	for (const std::vector<size_t>& indices : files)
+	{
+		for (size_t index : indices)
+		{
+			ASSERT_EQ(index, expected++);
+		}
+	}
+
+	ASSERT_EQ(expected, records);
+	ASSERT_GT(files.size(), 1);
+
+	std::filesystem::remove_all(asynchronousPath);
+}
+
+struct BackpressureResult
+{
+	size_t information = 0;
+	size_t errors = 0;
+	size_t dropped = 0;
+	size_t summaries = 0;
+};
+
+static BackpressureResult logWithBackpressure(Log::BackpressurePolicy policy, size_t overflowCapacity)
+{
+	static constexpr size_t records = 20000;
+
+	std::filesystem::path backpressurePath = std::filesystem::current_path() / "backpressure-logs";
+	BackpressureResult result;
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = backpressurePath;
+		settings.writeMode = Log::WriteMode::asynchronous;
+		settings.queueCapacity = 2;
+		settings.backpressurePolicy = policy;
+		settings.overflowCapacity = overflowCapacity;
+
+		Log::Logger logger(settings);
+
+		for (size_t i = 0; i < records; i++)
+		{
+			if (i % 10)
+			{
+				logger.info("Backpressure information {}", "LogInformation", i);
+			}
+			else
+			{
+				logger.error("Backpressure error {}", "LogError", i);
+			}
+		}
+	}
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(backpressurePath))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		std::ifstream in(entry.path());
+		std::string line;
+
+		while (std::getline(in, line))
+		{
+			if (line.find("Backpressure information") != std::string::npos)
+			{
+				result.information++;
+			}
+			else if (line.find("Backpressure error") != std::string::npos)
+			{
+				result.errors++;
+			}
+			else if (line.ends_with(" messages dropped"))
+			{
+				static constexpr std::string_view summary = " Log: WARNING: ";
+
+				size_t position = line.find(summary);
+
+				if (position == std::string::npos)
+				{
+					ADD_FAILURE() << "Dropped summary without Log category: " << line;
+
+					continue;
+				}
+
+				result.dropped += std::stoull(line.substr(position + summary.size()));
+				result.summaries++;
+			}
+		}
+	}
+
+	std::filesystem::remove_all(backpressurePath);
+
+	EXPECT_EQ(result.information + result.errors + result.dropped, records);
+
+	return result;
+}
+
+TEST(Log, BackpressureLogging)
+{
+	BackpressureResult block = logWithBackpressure(Log::BackpressurePolicy::block, 0);
+
+	ASSERT_EQ(block.information, 18000);
+	ASSERT_EQ(block.errors, 2000);
+	ASSERT_EQ(block.summaries, 0);
+
+	BackpressureResult dropNewest = logWithBackpressure(Log::BackpressurePolicy::dropNewest, 0);
+
+	ASSERT_GT(dropNewest.dropped, 0);
+	ASSERT_GT(dropNewest.summaries, 0);
+
+	BackpressureResult dropBelowLevel = logWithBackpressure(Log::BackpressurePolicy::dropBelowLevel, 0);
+
+	ASSERT_EQ(dropBelowLevel.errors, 2000);
+	ASSERT_GT(dropBelowLevel.dropped, 0);
+
+	BackpressureResult spill = logWithBackpressure(Log::BackpressurePolicy::spillToOverflowBuffer, 20000);
+
+	ASSERT_EQ(spill.information, 18000);
+	ASSERT_EQ(spill.errors, 2000);
+	ASSERT_EQ(spill.summaries, 0);
+
+	BackpressureResult spillOverflow = logWithBackpressure(Log::BackpressurePolicy::spillToOverflowBuffer, 1);
+
+	ASSERT_GT(spillOverflow.dropped, 0);
+	ASSERT_GT(spillOverflow.summaries, 0);
+}
+
+static bool waitForLogFile(const std::filesystem::path& logFilePath, std::string_view message, std::chrono::milliseconds timeout)
+{
+	auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	do
+	{
+		std::ifstream in(logFilePath);
+		std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+		if (temp.find(message) != std::string::npos)
+		{
+			return true;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	} while (std::chrono::steady_clock::now() < deadline);
+
+	return false;
+}
+
+TEST(Log, FlushPolicyLogging)
+{
+	std::filesystem::path flushPath = std::filesystem::current_path() / "flush-logs";
+
+	for (Log::WriteMode writeMode : { Log::WriteMode::synchronous, Log::WriteMode::asynchronous })
+	{
+		std::filesystem::path modePath = flushPath / (writeMode == Log::WriteMode::synchronous ? "synchronous" : "asynchronous");
+		Log::Settings intervalSettings;
+		Log::Settings bytesSettings;
+
+		intervalSettings.pathToLogs = modePath / "interval";
+		intervalSettings.writeMode = writeMode;
+		intervalSettings.flushPolicy.everyRecord = false;
+		intervalSettings.flushPolicy.interval = std::chrono::milliseconds(50);
+
+		bytesSettings.pathToLogs = modePath / "bytes";
+		bytesSettings.writeMode = writeMode;
+		bytesSettings.flushPolicy.everyRecord = false;
+		bytesSettings.flushPolicy.bytes = 1024 * 1024;
+
+		Log::Logger interval(intervalSettings);
+		Log::Logger bytes(bytesSettings);
+
+		interval.info("Interval message", "LogInformation");
+		bytes.info("Bytes message", "LogInformation");
+
+		// Flushed by timer without next record
+		ASSERT_TRUE(waitForLogFile(interval.getCurrentLogFilePath(), "Interval message", std::chrono::seconds(5)));
+
+		// Stays buffered until threshold is reached, idle writer doesn't flush
+		ASSERT_FALSE(waitForLogFile(bytes.getCurrentLogFilePath(), "Bytes message", std::chrono::milliseconds(200)));
+
+		bytes.flush();
+
+		ASSERT_TRUE(waitForLogFile(bytes.getCurrentLogFilePath(), "Bytes message", std::chrono::milliseconds(0)));
+	}
+
+	std::filesystem::remove_all(flushPath);
+}
+
+TEST(Log, BinaryLogging)
+{
+	std::filesystem::path binaryPath = std::filesystem::current_path() / "binary-logs";
+	std::filesystem::path textPath = std::filesystem::current_path() / "text-logs";
+	std::vector<std::string> decoded;
+	std::vector<std::string> text;
+
+	{
+		Log::Settings binarySettings;
+		Log::Settings textSettings;
+
+		binarySettings.pathToLogs = binaryPath;
+		binarySettings.logFileSize = 512;
+		binarySettings.binaryLog = true;
+		binarySettings.layout = "%tid %cat: %lvl: %msg";
+
+		textSettings.pathToLogs = textPath;
+		textSettings.layout = binarySettings.layout;
+
+		Log::Logger binary(binarySettings);
+		Log::Logger textLogger(textSettings);
+		std::string runtimeFormat = "Runtime format {} {:.3f} {:>6}";
+		std::string argument = "string";
+		int value = 0;
+
+		for (int i = 0; i < 20; i++)
+		{
+			for (Log::Logger* logger : { &binary, &textLogger })
+			{
+				logger->info("Static format {} {} {} {}", "LogInformation", i, argument, std::string_view("view"), "literal");
+				logger->warning(runtimeFormat, "LogWarning", i, 2.0 / 3.0, true);
+				logger->error("Floating point {} {} {} {:.2f}", "LogError", i, 0.1f, 0.1, 0.1L);
+				logger->info("Pointer {} {} {}", "LogInformation", i, static_cast<const void*>(&value), nullptr);
+				logger->info("Character {} and unsigned {}", "LogInformation", 'c', static_cast<uint64_t>(i));
+				logger->info("Field {} {:04} {:.1f} {}", "LogInformation", Log::field("path", argument), Log::field("status", i), Log::field("elapsed", 1.5), Log::field("pointer", nullptr));
+			}
+		}
+	}
+
+	size_t binaryFiles = 0;
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(binaryPath))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		std::ifstream in(entry.path(), std::ios::binary);
+		std::stringstream out;
+
+		Log::decodeBinaryLog(in, out);
+
+		for (std::string line; std::getline(out, line);)
+		{
+			decoded.push_back(std::move(line));
+		}
+
+		binaryFiles++;
+	}
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(textPath))
+	{
+		if (entry.is_regular_file())
+		{
+			std::ifstream in(entry.path());
+
+			for (std::string line; std::getline(in, line);)
+			{
+				text.push_back(std::move(line));
+			}
+		}
+	}
+
+	// Rotated binary log files are decoded independently, names don't keep order
+	std::ranges::sort(decoded);
+	std::ranges::sort(text);
+
+	ASSERT_GT(binaryFiles, 1);
+	ASSERT_EQ(decoded.size(), 120);
+	ASSERT_EQ(decoded, text);
+
+	std::filesystem::remove_all(binaryPath);
+	std::filesystem::remove_all(textPath);
+}
+
+TEST(Log, CompressedLogging)
+{
+	static constexpr size_t frameSize = 1024 * 1024;
+
+	std::string_view extension = Log::getCompressedLogFileExtension();
+
+	if (extension.empty())
+	{
+		GTEST_SKIP() << "zstd and zlib were not found at configure time";
+	}
+
+	std::filesystem::path compressedPath = std::filesystem::current_path() / "compressed-logs";
+	std::filesystem::path compressedLogFile;
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = compressedPath;
+		settings.logFileSize = 3 * frameSize;
+		settings.compressRotatedLogFiles = true;
+
+		Log::Logger logger(settings);
+		std::filesystem::path firstLogFile = logger.getCurrentLogFilePath();
+
+		for (size_t i = 0; logger.getCurrentLogFilePath() == firstLogFile; i++)
+		{
+			logger.info("Compressed message {}", "LogInformation", i);
+		}
+
+		std::filesystem::file_time_type rotationTime = std::filesystem::file_time_type::clock::now();
+
+		compressedLogFile = std::filesystem::path(firstLogFile) += extension;
+
+		for (size_t i = 0; i < 1000 && std::filesystem::exists(firstLogFile); i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		ASSERT_FALSE(std::filesystem::exists(firstLogFile));
+
+		// Compressed log file keeps age of log file for retention
+		ASSERT_LE(std::filesystem::last_write_time(compressedLogFile), rotationTime);
+	}
+
+	std::ifstream in(compressedLogFile, std::ios::binary);
+	std::string compressed = (std::ostringstream() << in.rdbuf()).str();
+	std::ifstream index(std::filesystem::path(compressedLogFile) += ".index");
+	std::string line;
+	uint64_t uncompressedOffset;
+	uint64_t compressedOffset;
+	uint64_t compressedSize;
+	uint64_t previousUncompressedOffset = 0;
+	uint64_t expectedUncompressedOffset = 0;
+	uint64_t expectedCompressedOffset = 0;
+	size_t frames = 0;
+
+	ASSERT_TRUE(std::getline(index, line));
+	ASSERT_TRUE(line.starts_with('#'));
+
+	while (index >> uncompressedOffset >> compressedOffset >> compressedSize)
+	{
+		ASSERT_EQ(compressedOffset, expectedCompressedOffset);
+		ASSERT_TRUE(frames ? uncompressedOffset > previousUncompressedOffset : uncompressedOffset == 0);
+		ASSERT_LE(compressedOffset + compressedSize, compressed.size());
+
+		std::string_view frame = std::string_view(compressed).substr(compressedOffset, compressedSize);
+
+		// Every frame is independent zstd frame or gzip member
+		if (extension == ".zst")
+		{
+			ASSERT_TRUE(frame.starts_with("\x28\xB5\x2F\xFD"));
+		}
+		else
+		{
+			uint32_t frameUncompressedSize;
+
+			ASSERT_TRUE(frame.starts_with("\x1F\x8B"));
+			ASSERT_EQ(uncompressedOffset, expectedUncompressedOffset);
+
+			// Last four bytes of gzip member are its uncompressed size
+			std::memcpy(&frameUncompressedSize, frame.data() + frame.size() - sizeof(frameUncompressedSize), sizeof(frameUncompressedSize));
+
+			ASSERT_LE(frameUncompressedSize, frameSize);
+
+			expectedUncompressedOffset += frameUncompressedSize;
+		}
+
+		previousUncompressedOffset = uncompressedOffset;
+		expectedCompressedOffset += compressedSize;
+		frames++;
+	}
+
+	ASSERT_EQ(expectedCompressedOffset, compressed.size());
+	ASSERT_GE(frames, 3);
+
+	if (extension == ".gz")
+	{
+		ASSERT_GE(expectedUncompressedOffset, 2 * frameSize);
+	}
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(compressedPath))
+	{
+		// Shutdown finishes log file that is being compressed
+		ASSERT_NE(entry.path().extension(), ".tmp");
+	}
+
+	std::filesystem::remove_all(compressedPath);
+
+	{
+		Log::Settings settings;
+		std::stringstream errors;
+		std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+
+		settings.pathToLogs = compressedPath;
+		settings.logFileSize = 64 * 1024;
+		settings.compressRotatedLogFiles = true;
+
+		{
+			Log::Logger logger(settings);
+			std::filesystem::path firstLogFile = logger.getCurrentLogFilePath();
+			std::filesystem::path secondLogFile;
+
+			// Compressed file can't replace directory
+			std::filesystem::create_directories(std::filesystem::path(firstLogFile) += extension);
+
+			for (size_t i = 0; secondLogFile.empty() || logger.getCurrentLogFilePath() == secondLogFile; i++)
+			{
+				logger.info("Failed compression message {}", "LogInformation", i);
+
+				if (secondLogFile.empty() && logger.getCurrentLogFilePath() != firstLogFile)
+				{
+					secondLogFile = logger.getCurrentLogFilePath();
+				}
+			}
+
+			// Log files are compressed in rotation order
+			for (size_t i = 0; i < 1000 && std::filesystem::exists(secondLogFile); i++)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			}
+
+			ASSERT_FALSE(std::filesystem::exists(secondLogFile));
+
+			// Failed compression keeps original log file and removes partial compressed file and index
+			ASSERT_TRUE(std::filesystem::exists(firstLogFile));
+			ASSERT_FALSE(std::filesystem::exists(std::filesystem::path(firstLogFile) += std::string(extension) + ".tmp"));
+			ASSERT_FALSE(std::filesystem::exists(std::filesystem::path(firstLogFile) += std::string(extension) + ".index"));
+		}
+
+		std::cerr.rdbuf(previous);
+
+		ASSERT_NE(errors.str().find("Can't rename"), std::string::npos);
+	}
+
+	std::filesystem::remove_all(compressedPath);
+}
+
+static std::vector<std::filesystem::path> waitForRetention(const std::filesystem::path& pathToLogs, const std::function<bool(const std::vector<std::filesystem::path>&)>& predicate)
+{
+	std::vector<std::filesystem::path> result;
+
+	for (size_t i = 0; i < 500; i++)
+	{
+		result.clear();
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(pathToLogs))
+		{
+			if (entry.is_regular_file())
+			{
+				result.push_back(entry.path());
+			}
+		}
+
+		if (predicate(result))
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	return result;
+}
+
+TEST(Log, RetentionLogging)
+{
+	std::filesystem::path retentionPath = std::filesystem::current_path() / "retention-logs";
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = retentionPath / "files";
+		settings.logFileSize = 1024;
+		settings.retentionPolicy.maxLogFiles = 3;
+
+		Log::Logger logger(settings);
+
+		for (size_t i = 0; i < 500; i++)
+		{
+			logger.info("Retention message {}", "LogInformation", i);
+		}
+
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+		std::vector<std::filesystem::path> logFiles = waitForRetention(settings.pathToLogs, [](const std::vector<std::filesystem::path>& logFiles) { return logFiles.size() <= 4; });
+
+		// Current log file is not counted
+		ASSERT_EQ(logFiles.size(), 4);
+		ASSERT_NE(std::ranges::find(logFiles, currentLogFile), logFiles.end());
+	}
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = retentionPath / "size";
+		settings.logFileSize = 1024;
+		settings.retentionPolicy.maxTotalSize = 4096;
+
+		Log::Logger logger(settings);
+
+		for (size_t i = 0; i < 500; i++)
+		{
+			logger.info("Retention message {}", "LogInformation", i);
+		}
+
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+		auto rotatedSize = [&currentLogFile](const std::vector<std::filesystem::path>& logFiles)
+			{
+				uintmax_t result = 0;
+
+				for (const std::filesystem::path& logFile : logFiles)
+				{
+					result += logFile != currentLogFile ? std::filesystem::file_size(logFile) : 0;
+				}
+
+				return result;
+			};
+		std::vector<std::filesystem::path> logFiles = waitForRetention(settings.pathToLogs, [&rotatedSize](const std::vector<std::filesystem::path>& logFiles) { return rotatedSize(logFiles) <= 4096; });
+
+		ASSERT_LE(rotatedSize(logFiles), 4096);
+		ASSERT_NE(std::ranges::find(logFiles, currentLogFile), logFiles.end());
+	}
+
+	{
+		Log::Settings settings;
+		std::filesystem::path oldFolder = retentionPath / "age" / "01.01.2020";
+
+		settings.pathToLogs = retentionPath / "age";
+		settings.retentionPolicy.maxAge = std::chrono::days(1);
+
+		std::filesystem::create_directories(oldFolder);
+
+		for (std::string_view name : { "old.log", "old.log.gz", "old.log.gz.index" })
+		{
+			std::ofstream(oldFolder / name) << "Old log file";
+
+			std::filesystem::last_write_time(oldFolder / name, std::filesystem::file_time_type::clock::now() - std::chrono::days(10));
+		}
+
+		Log::Logger logger(settings);
+
+		logger.info("Retention message", "LogInformation");
+
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+
+		// Existing log files are indexed at start, old log file is removed with its compressed variants and folder
+		std::vector<std::filesystem::path> logFiles = waitForRetention(settings.pathToLogs, [](const std::vector<std::filesystem::path>& logFiles) { return logFiles.size() == 1; });
+
+		ASSERT_EQ(logFiles, std::vector<std::filesystem::path>{ currentLogFile });
+		ASSERT_FALSE(std::filesystem::exists(oldFolder));
+	}
+
+	if (!Log::getCompressedLogFileExtension().empty())
+	{
+		Log::Settings settings;
+		std::stringstream errors;
+		std::streambuf* previous = std::cerr.rdbuf(errors.rdbuf());
+
+		settings.pathToLogs = retentionPath / "compressed";
+		settings.logFileSize = 64 * 1024;
+		settings.compressRotatedLogFiles = true;
+		settings.retentionPolicy.maxLogFiles = 1;
+
+		{
+			Log::Logger logger(settings);
+
+			for (size_t i = 0; i < 50'000; i++)
+			{
+				logger.info("Compressed retention message {}", "LogInformation", i);
+			}
+		}
+
+		std::cerr.rdbuf(previous);
+
+		// Log file waiting for compression is never removed, otherwise compressor can't open it
+		ASSERT_EQ(errors.str(), "");
+	}
+
+	std::filesystem::remove_all(retentionPath);
+}
+
+TEST(Log, FileBackendThroughput)
+{
+	static constexpr size_t cycles = 500'000;
+
+	std::filesystem::path backendPath = std::filesystem::current_path() / "backend-logs";
+	double streamSeconds = 0.0;
+
+	for (Log::FileBackend fileBackend : { Log::FileBackend::stream, Log::FileBackend::batched, Log::FileBackend::uring })
+	{
+		std::string_view name = fileBackend == Log::FileBackend::stream ? "stream" : fileBackend == Log::FileBackend::batched ? "batched" : "uring";
+		double resultSeconds;
+
+		{
+			Log::Settings settings;
+
+			settings.pathToLogs = backendPath / name;
+			settings.fileBackend = fileBackend;
+			settings.flushPolicy.everyRecord = false;
+
+			Log::Logger logger(settings);
+
+#ifdef __LINUX__
+			// Without io_uring uring falls back to batched
+			ASSERT_TRUE(logger.getFileBackend() == fileBackend || (fileBackend == Log::FileBackend::uring && logger.getFileBackend() == Log::FileBackend::batched));
+#else
+			ASSERT_EQ(logger.getFileBackend(), Log::FileBackend::stream);
+#endif
+
+			auto start = std::chrono::high_resolution_clock::now();
+
+			for (size_t i = 0; i < cycles; i++)
+			{
+				logger.info("Log some information with current index {} and line {}", "LogTest", i, __LINE__);
+			}
+
+			logger.flush();
+
+			auto end = std::chrono::high_resolution_clock::now();
+
+			resultSeconds = static_cast<double>((end - start).count()) / std::chrono::high_resolution_clock::period::den;
+		}
+
+		if (fileBackend == Log::FileBackend::stream)
+		{
+			streamSeconds = resultSeconds;
+		}
+
+		std::cout << name << ": " << cycles / resultSeconds << " messages per second, " << streamSeconds / resultSeconds << " times stream" << std::endl;
+
+		size_t written = 0;
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(backendPath / name))
+		{
+			if (entry.is_regular_file())
+			{
+				std::ifstream in(entry.path());
+
+				written += std::ranges::count(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>(), '\n');
+			}
+		}
+
+		ASSERT_EQ(written, cycles);
+	}
+
+	std::filesystem::remove_all(backendPath);
+}
+
+#ifdef __LINUX__
+TEST(Log, MappedLogging)
+{
+	static constexpr size_t threadsCount = 4;
+	static constexpr size_t records = 5000;
+
+	std::filesystem::path mappedPath = std::filesystem::current_path() / "mapped-logs";
+	std::filesystem::path crashedLogFile = mappedPath / "01.01.2000" / "crashed.log";
+	std::string longRecord(10000, '#');
+
+	// Mapped log file of crashed process in folder of previous day
+	std::filesystem::create_directories(crashedLogFile.parent_path());
+
+	(std::ofstream(crashedLogFile, std::ios::binary) << "Crashed record\n").write(std::string(4096, '\0').data(), 4096);
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = mappedPath;
+		settings.logFileSize = 4096;
+		settings.fileBackend = Log::FileBackend::mapped;
+
+		Log::Logger logger(settings);
+		std::vector<std::thread> threads;
+
+		ASSERT_EQ(std::filesystem::file_size(crashedLogFile), std::string_view("Crashed record\n").size());
+
+		// Record longer than log file is split into several lines
+		logger.info("{}", "LogInformation", longRecord);
+
+		for (size_t i = 0; i < threadsCount; i++)
+		{
+			threads.emplace_back([&logger, i]()
+				{
+					for (size_t j = 0; j < records; j++)
+					{
+						logger.info("Mapped message {} {}", "LogInformation", i, j);
+					}
+				});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	size_t written = 0;
+	size_t longRecordSize = 0;
+	size_t logFiles = 0;
+
+	std::filesystem::remove_all(crashedLogFile.parent_path());
+
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(mappedPath))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		std::ifstream in(entry.path());
+		std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+		// Retired segments are truncated to written records
+		ASSERT_EQ(temp.find('\0'), std::string::npos);
+
+		for (size_t position = temp.find("Mapped message"); position != std::string::npos; position = temp.find("Mapped message", position + 1))
+		{
+			written++;
+		}
+
+		longRecordSize += std::ranges::count(temp, '#');
+
+		logFiles++;
+	}
+
+	ASSERT_EQ(written, threadsCount * records);
+	ASSERT_EQ(longRecordSize, longRecord.size());
+	ASSERT_GT(logFiles, 1);
+
+	std::filesystem::remove_all(mappedPath);
+}
+#endif
+
+TEST(Log, DurableLogging)
+{
+	std::filesystem::path durablePath = std::filesystem::current_path() / "durable-logs";
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = durablePath;
+		settings.logFileSize = 1024;
+		settings.durableLevel = Log::VerbosityLevel::error;
+
+		Log::Logger logger(settings);
+
+		logger.sync();
+
+		Log::DurabilityStatistics before = logger.getDurabilityStatistics();
+
+		logger.info("Not durable message", "LogInformation");
+		logger.error("Durable message", "LogError");
+
+		Log::DurabilityStatistics after = logger.getDurabilityStatistics();
+
+		ASSERT_EQ(after.syncs, before.syncs + 1);
+		ASSERT_EQ(after.lastSyncRecords, 2);
+		ASSERT_EQ(after.records, before.records + 2);
+
+		logger.info("Synced message", "LogInformation");
+
+		logger.sync();
+
+		ASSERT_EQ(logger.getDurabilityStatistics().syncs, after.syncs + 1);
+
+		// Rotated log files are synced on background thread, durable record still covers all previous records
+		std::filesystem::path currentLogFile = logger.getCurrentLogFilePath();
+
+		for (size_t i = 0; logger.getCurrentLogFilePath() == currentLogFile; i++)
+		{
+			logger.info("Rotated message {}", "LogInformation", i);
+		}
+
+		uint64_t records = logger.getDurabilityStatistics().records;
+
+		logger.error("Durable message after rotation", "LogError");
+
+		ASSERT_GT(logger.getDurabilityStatistics().records, records + 1);
+	}
+
+	{
+		Log::Settings settings;
+
+		settings.pathToLogs = durablePath;
+		settings.durableLevel = Log::VerbosityLevel::error;
+		settings.durableMaxWait = std::chrono::milliseconds(500);
+
+		Log::Logger logger(settings);
+		std::vector<std::thread> threads;
+		auto start = std::chrono::steady_clock::now();
+
+		// Sync without other pending callers doesn't wait
+		logger.error("First durable message", "LogError");
+
+		ASSERT_LT(std::chrono::steady_clock::now() - start, settings.durableMaxWait);
+
+		// Leader stops waiting when as many callers are pending as last sync covered
+		for (size_t i = 0; i < 8; i++)
+		{
+			threads.emplace_back([&logger, i]() { logger.error("Concurrent durable message {}", "LogError", i); });
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		ASSERT_EQ(logger.getDurabilityStatistics().records, 9);
+
+		// Large sync doesn't make later lone callers wait
+		start = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < 3; i++)
+		{
+			logger.error("Later durable message {}", "LogError", i);
+		}
+
+		ASSERT_LT(std::chrono::steady_clock::now() - start, settings.durableMaxWait);
+	}
+
+	std::filesystem::remove_all(durablePath);
+}
+
+TEST(Log, SinkLogging)
+{
+	std::shared_ptr<Log::RingSink> ring = std::make_shared<Log::RingSink>(2);
+	std::vector<std::string> errors;
+	std::shared_ptr<Log::CallbackSink> callback = std::make_shared<Log::CallbackSink>([&errors](std::string_view record, Log::VerbosityLevel level) { errors.emplace_back(record); }, Log::VerbosityLevel::error);
+
+	Log::addSink(ring);
+	Log::addSink(callback);
+
+	Log::info("First sink message", "LogInformation");
+	Log::error("Second sink message", "LogError");
+	Log::warning("Third sink message", "LogWarning");
+
+	Log::flush();
+
+	std::vector<std::shared_ptr<const std::string>> records = ring->getRecords();
+
+	ASSERT_EQ(records.size(), 2);
+	ASSERT_NE(records[0]->find("Second sink message"), std::string::npos);
+	ASSERT_NE(records[1]->find("Third sink message"), std::string::npos);
+	ASSERT_EQ(errors.size(), 1);
+	ASSERT_NE(errors[0].find("Second sink message"), std::string::npos);
+
+	ASSERT_TRUE(Log::removeSink(ring));
+	ASSERT_TRUE(Log::removeSink(callback));
+	ASSERT_FALSE(Log::removeSink(ring));
+}
+
+TEST(Log, FilteredLoggingAllocations)
+{
+	std::string argument = "some string argument";
+
+	Log::setVerbosityLevel(Log::VerbosityLevel::error);
+
+	size_t allocationsBefore = allocationsCount;
+
+	Log::info("This info message should not be formatted {} {} {}", "LogInformation", argument, 5, 1.5);
+	Log::warning("This warning message should not be formatted {} {} {}", "LogWarning", argument, 5, 1.5);
+
+	size_t allocationsAfter = allocationsCount;
+
+	Log::setVerbosityLevel(Log::VerbosityLevel::verbose);
+
+	ASSERT_EQ(allocationsBefore, allocationsAfter);
+}
+
+TEST(Log, LoggingAllocations)
+{
+	static constexpr size_t cycles = 100;
+
+	std::string argument = "some string argument";
+
+	Log::info("Warm up message {} {} {}", "LogInformation", argument, 5, 1.5);
+
+	size_t allocationsBefore = allocationsCount;
+
+	for (size_t i = 0; i < cycles; i++)
+	{
+		Log::info("Steady state message {} {} {}", "LogInformation", argument, i, 1.5);
+	}
+
+	size_t allocationsAfter = allocationsCount;
+
+	ASSERT_EQ(allocationsBefore, allocationsAfter);
+}
+
+struct NestedLoggingValue
+{
+	int value;
+};
+
+template<>
+struct std::formatter<NestedLoggingValue> : std::formatter<int>
+{
+	auto format(const NestedLoggingValue& value, auto& context) const
+	{
+		Log::info("Nested message {}", "LogInformation", value.value);
+
+		return std::formatter<int>::format(value.value, context);
+	}
+};
+
+TEST(Log, NestedLogging)
+{
+	Log::info("Outer message {} with nested record", "LogInformation", NestedLoggingValue{ 7 });
+
+	std::ifstream in(Log::getCurrentLogFilePath());
+	std::string temp = (std::ostringstream() << in.rdbuf()).str();
+
+	ASSERT_NE(temp.find("Nested message 7\n"), std::string::npos);
+	ASSERT_NE(temp.find("Outer message 7 with nested record\n"), std::string::npos);
+}
+
 int main(int argc, char** argv)
 {
 	testing::InitGoogleTest(&argc, argv);
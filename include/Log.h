@@ -18,6 +18,13 @@
 #include <vector>
 #include <atomic>
 #include <functional>
+#include <thread>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <array>
+#include <unordered_map>
+#include <cmath>
 
 #ifdef NDEBUG
 #define LOG_DEBUG_INFO(format, category, ...)
@@ -39,6 +46,16 @@
 #define LOG_IF_VALID_FATAL_ERROR(format, category, ...) if (Log::isValid()) { Log::fatalError(format, category, exitCode, __VA_ARGS__); }
 #endif
 
+#define LOG_INFO_EVERY(n, format, category, ...) do { static Log::EverySite logEverySite; Log::infoEvery(logEverySite, n, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_WARNING_EVERY(n, format, category, ...) do { static Log::EverySite logEverySite; Log::warningEvery(logEverySite, n, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_ERROR_EVERY(n, format, category, ...) do { static Log::EverySite logEverySite; Log::errorEvery(logEverySite, n, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_INFO_LIMITED(count, period, format, category, ...) do { static Log::RateLimitSite logRateLimitSite; Log::infoLimited(logRateLimitSite, count, period, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_WARNING_LIMITED(count, period, format, category, ...) do { static Log::RateLimitSite logRateLimitSite; Log::warningLimited(logRateLimitSite, count, period, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_ERROR_LIMITED(count, period, format, category, ...) do { static Log::RateLimitSite logRateLimitSite; Log::errorLimited(logRateLimitSite, count, period, format, category __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_INFO(format, category, ...) do { static const Log::CategorySite logCategorySite(category); Log::info(format, logCategorySite __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_WARNING(format, category, ...) do { static const Log::CategorySite logCategorySite(category); Log::warning(format, logCategorySite __VA_OPT__(,) __VA_ARGS__); } while (false)
+#define LOG_ERROR(format, category, ...) do { static const Log::CategorySite logCategorySite(category); Log::error(format, logCategorySite __VA_OPT__(,) __VA_ARGS__); } while (false)
+
 class LOG_API Log
 {
 private:
@@ -52,6 +69,93 @@ private:
 
 	static inline constexpr size_t additionalInformationSize = 128;
 
+	/**
+	 * @brief Number of different categories that can have own verbosity level in process, ids stay reserved after reset. Each category of CategorySite takes id, text categories only take it with level
+	 */
+	static inline constexpr size_t maxCategoryLevels = 256;
+
+	template<typename T>
+	static inline constexpr bool isRuntimeFormat = !std::is_array_v<T> && std::is_convertible_v<const T&, std::string_view>;
+
+	/**
+	 * @brief Compiled layout step
+	 */
+	enum class LayoutOperation : uint8_t
+	{
+		text,
+		utcDate,
+		localDate,
+		threadId,
+		category,
+		level,
+		message,
+		isoUtcDate, /// JSON string with ISO 8601 UTC time
+		isoLocalDate, /// JSON string with ISO 8601 local time and UTC offset
+		jsonThreadId,
+		jsonCategory,
+		jsonMessage,
+		jsonFields /// Log::Field arguments
+	};
+
+	struct LayoutSegment
+	{
+		LayoutOperation operation;
+		std::string text;
+	};
+
+	/**
+	 * @brief Log file from current day folder with free space
+	 */
+	struct LogSegment
+	{
+		std::filesystem::path path;
+		uintmax_t size;
+	};
+
+	class RecordQueue;
+
+	class SegmentPreparer;
+	class DurableSync;
+	class BatchedFileWriter;
+	class MappedSegmentWriter;
+	class UringFileWriter;
+	class BinaryLog;
+	class SegmentCompressor;
+	class RetentionEnforcer;
+	class SinkDispatcher;
+	class SuppressionReporter;
+	class FlushTimer;
+	class JsonEscaper;
+	class SharedWriter;
+
+	/**
+	 * @brief Entry of .binlog file. Each entry is type, payload size (uint32_t) and payload
+	 */
+	enum class BinaryEntry : uint8_t
+	{
+		header, /// Layout, date format and time zone name of writing process. Resets call site and thread definitions
+		callSite, /// Call site id and format
+		thread, /// Thread index and rendered thread id
+		zoneOffset, /// UTC offset in seconds for following records
+		record /// Call site id, thread index, level, timestamp, category and arguments
+	};
+
+	/**
+	 * @brief Type of argument in binary record
+	 */
+	enum class BinaryArgument : uint8_t
+	{
+		boolean,
+		character,
+		signedInteger,
+		unsignedInteger,
+		floatingPoint, /// double
+		string,
+		pointer,
+		singleFloatingPoint, /// float
+		extendedFloatingPoint /// long double, size in bytes before value
+	};
+
 public:
 	/**
 	 * @brief Specifies verbosity levels for logging.
@@ -64,7 +168,7 @@ public:
 	};
 
 	/**
-	 * @brief Defaut size of each log file 128 MiB
+	 * @brief Size of each log file of default logger, 128 MiB until configure changes it. Default of Settings::logFileSize, Logger uses its own Settings::logFileSize
 	 */
 	static inline uintmax_t logFileSize = 128 * 1024 * 1024;
 
@@ -73,6 +177,31 @@ public:
 	 */
 	static inline constexpr std::string_view fileExtension = ".log";
 
+	/**
+	 * @brief File extension for files generated with Settings::binaryLog
+	 */
+	static inline constexpr std::string_view binaryFileExtension = ".binlog";
+
+	/**
+	 * @brief Default number of records in asynchronous queue
+	 */
+	static inline constexpr size_t defaultQueueCapacity = 8192;
+
+	/**
+	 * @brief Default number of records in overflow buffer for BackpressurePolicy::spillToOverflowBuffer
+	 */
+	static inline constexpr size_t defaultOverflowCapacity = 65536;
+
+	/**
+	 * @brief Default buffer size of FileBackend::batched 1 MiB
+	 */
+	static inline constexpr size_t defaultBatchSize = 1024 * 1024;
+
+	/**
+	 * @brief Default number of records waiting for each Sink
+	 */
+	static inline constexpr size_t defaultSinkCapacity = 8192;
+
 public:
 	/**
 	 * @brief Logging date format
@@ -96,69 +225,688 @@ public:
 		threadId = 16 /// add thread id
 	};
 
+	/**
+	 * @brief Where records are written to file and sinks
+	 */
+	enum class WriteMode
+	{
+		synchronous, /// Caller thread writes record
+		asynchronous /// Caller thread pushes record into queue, background thread writes it
+	};
+
+	/**
+	 * @brief Thread identifier written by AdditionalInformation::threadId and %tid
+	 */
+	enum class ThreadIdFormat
+	{
+		standard, /// std::this_thread::get_id
+		system /// Operating system thread id (gettid, GetCurrentThreadId) as shown by top, perf and debuggers
+	};
+
+	/**
+	 * @brief What happens with record when asynchronous queue is full
+	 */
+	enum class BackpressurePolicy
+	{
+		block, /// Wait for free space in queue
+		dropNewest, /// Drop record
+		dropBelowLevel, /// Drop record below Settings::backpressureLevel, wait for free space for others
+		spillToOverflowBuffer /// Move record into overflow buffer, drop record if overflow buffer is full
+	};
+
+	/**
+	 * @brief How records are written to log file
+	 */
+	enum class FileBackend
+	{
+		stream, /// std::ofstream
+		batched, /// Aligned buffer written with writev in big batches. POSIX only, std::ofstream on other platforms
+		mapped, /// Log file mapped into memory, writers copy records without locks and Settings::writeMode is ignored. POSIX only, std::ofstream on other platforms
+		uring /// Buffers submitted through io_uring with several writes in flight. Linux only, batched if io_uring is not available, std::ofstream on other platforms. Log::getFileBackend tells which one is used
+	};
+
+	/**
+	 * @brief When log file is flushed. Without any trigger operating system decides. Sinks flush after each batch on their own threads
+	 */
+	struct FlushPolicy
+	{
+		bool everyRecord = true; /// Flush after each record
+		size_t bytes = 0; /// Flush when at least this many bytes were written since last flush. 0 to disable
+		std::chrono::milliseconds interval = std::chrono::milliseconds(0); /// Flush when this much time passed since last flush, also when nothing else is logged. 0 to disable
+		std::optional<VerbosityLevel> level; /// Flush immediately after records at or above this level
+	};
+
+	/**
+	 * @brief Limits for log files in Settings::pathToLogs. Oldest log files are removed on background thread until all limits are met. Current log file is not counted
+	 */
+	struct RetentionPolicy
+	{
+		uintmax_t maxTotalSize = 0; /// Maximum size in bytes of all log files, compressed log files and their indices. 0 to disable
+		std::chrono::days maxAge = std::chrono::days(0); /// Remove log files last written more than this many days ago. 0 to disable
+		size_t maxLogFiles = 0; /// Maximum number of log files. 0 to disable
+	};
+
+	/**
+	 * @brief Group commit counters of durable mode
+	 */
+	struct DurabilityStatistics
+	{
+		uint64_t syncs; /// Number of syncs to stable storage
+		uint64_t records; /// Number of records covered by all syncs
+		uint64_t lastSyncRecords; /// Number of records covered by last sync
+		uint64_t maxSyncRecords; /// Maximum number of records covered by one sync
+	};
+
+	/**
+	 * @brief Call site state of Log::infoEvery, Log::warningEvery and Log::errorEvery. Must be static at call site, LOG_*_EVERY macros declare it
+	 */
+	class LOG_API EverySite
+	{
+	private:
+		std::atomic<uint64_t> calls;
+
+	public:
+		EverySite();
+
+		/**
+		 * @brief Count call
+		 * @return true for first and every n-th call
+		 */
+		bool sample(uint64_t n);
+
+		~EverySite() = default;
+	};
+
+	/**
+	 * @brief Call site state of Log::infoLimited, Log::warningLimited and Log::errorLimited. Must be static at call site, LOG_*_LIMITED macros declare it
+	 */
+	class LOG_API RateLimitSite
+	{
+	private:
+		static inline constexpr int windowShift = 40;
+		static inline constexpr uint64_t recordsMask = (uint64_t(1) << windowShift) - 1;
+
+		std::atomic<uint64_t> state; /// Index of steady clock period in high 24 bits, records of this period in low 40 bits
+
+		/**
+		 * @brief Index of current period shifted into state
+		 */
+		static uint64_t getWindow(std::chrono::nanoseconds period);
+
+		/**
+		 * @brief Records above count in ended period of window, they stay counted as reported
+		 * @return 0 if other period started or nothing was suppressed
+		 */
+		uint64_t takeSuppressed(uint32_t count, uint64_t window);
+
+		friend class Log;
+		friend class Log::SuppressionReporter;
+
+	public:
+		RateLimitSite();
+
+		/**
+		 * @brief Reports suppressed records and stops summary for this call site
+		 */
+		~RateLimitSite();
+	};
+
+	/**
+	 * @brief Category interned once per call site, its id indexes category verbosity levels without lookup. Must be static at call site, LOG_INFO, LOG_WARNING and LOG_ERROR declare it
+	 */
+	class LOG_API CategorySite
+	{
+	private:
+		std::string name;
+		uint32_t id; /// maxCategoryLevels when other categories took all ids, category uses global verbosity level then
+
+		friend class Log;
+
+	public:
+		/**
+		 * @param category Same category at every call of this site
+		 */
+		explicit CategorySite(std::string_view category);
+
+		~CategorySite() = default;
+	};
+
+	/**
+	 * @brief Category argument of logging functions. Text category is looked up by name while any category has verbosity level, CategorySite passes its id
+	 */
+	class Category
+	{
+	private:
+		std::string_view name;
+		const CategorySite* site;
+
+		friend class Log;
+
+	public:
+		Category(const char* name) :
+			name(name),
+			site(nullptr)
+		{
+
+		}
+
+		Category(std::string_view name) :
+			name(name),
+			site(nullptr)
+		{
+
+		}
+
+		Category(const std::string& name) :
+			name(name),
+			site(nullptr)
+		{
+
+		}
+
+		Category(const CategorySite& site) :
+			name(site.name),
+			site(&site)
+		{
+
+		}
+
+		operator std::string_view() const
+		{
+			return name;
+		}
+	};
+
+	/**
+	 * @brief Destination of text records besides log file. Each sink has own thread and queue of records, slow sink doesn't hold back log file and other sinks
+	 */
+	class LOG_API Sink
+	{
+	private:
+		VerbosityLevel level;
+		size_t capacity;
+		std::atomic<uint64_t> droppedCount;
+
+		friend class Log::SinkDispatcher;
+
+	public:
+		/**
+		 * @param level Minimum level of records written to this sink
+		 * @param capacity Maximum number of records waiting for this sink. Newest records are dropped when queue is full
+		 */
+		Sink(VerbosityLevel level = VerbosityLevel::verbose, size_t capacity = Log::defaultSinkCapacity);
+
+		/**
+		 * @brief Minimum level of records written to this sink
+		 */
+		VerbosityLevel getLevel() const;
+
+		/**
+		 * @brief Maximum number of records waiting for this sink
+		 */
+		size_t getCapacity() const;
+
+		/**
+		 * @brief Number of records dropped because queue of this sink was full
+		 */
+		uint64_t getDroppedCount() const;
+
+		/**
+		 * @brief Write record on sink thread. Must not log, Log::flush waits for sinks
+		 * @param record Formatted record without line break. Same buffer is shared with all sinks and must not be modified, keep pointer to retain record without copying
+		 * @param level Record level, fatal errors are VerbosityLevel::error
+		 */
+		virtual void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) = 0;
+
+		/**
+		 * @brief Called on sink thread after each batch of written records
+		 */
+		virtual void flush();
+
+		virtual ~Sink() = default;
+	};
+
+	/**
+	 * @brief Writes records into std::ostream, for example std::cout
+	 */
+	class LOG_API StreamSink : public Sink
+	{
+	private:
+		std::ostream& stream;
+
+	public:
+		StreamSink(std::ostream& stream, VerbosityLevel level = VerbosityLevel::verbose, size_t capacity = Log::defaultSinkCapacity);
+
+		void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) override;
+
+		void flush() override;
+
+		~StreamSink() = default;
+	};
+
+	/**
+	 * @brief Appends records to file without rotation
+	 */
+	class LOG_API FileSink : public Sink
+	{
+	private:
+		std::ofstream file;
+
+	public:
+		/**
+		 * @exception std::runtime_error Can't open file
+		 */
+		FileSink(const std::filesystem::path& path, VerbosityLevel level = VerbosityLevel::verbose, size_t capacity = Log::defaultSinkCapacity);
+
+		void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) override;
+
+		void flush() override;
+
+		~FileSink() = default;
+	};
+
+	/**
+	 * @brief Calls function for each record on sink thread. Function must not log
+	 */
+	class LOG_API CallbackSink : public Sink
+	{
+	private:
+		std::function<void(std::string_view, VerbosityLevel)> callback;
+
+	public:
+		CallbackSink(const std::function<void(std::string_view, VerbosityLevel)>& callback, VerbosityLevel level = VerbosityLevel::verbose, size_t capacity = Log::defaultSinkCapacity);
+
+		void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) override;
+
+		~CallbackSink() = default;
+	};
+
+	/**
+	 * @brief Keeps last records in memory, for example to attach them to crash report
+	 */
+	class LOG_API RingSink : public Sink
+	{
+	private:
+		mutable std::mutex ringMutex;
+		std::vector<std::shared_ptr<const std::string>> records;
+		size_t next;
+
+	public:
+		/**
+		 * @param size Number of kept records
+		 */
+		RingSink(size_t size, VerbosityLevel level = VerbosityLevel::verbose, size_t capacity = Log::defaultSinkCapacity);
+
+		void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) override;
+
+		/**
+		 * @brief Kept records from oldest to newest
+		 */
+		std::vector<std::shared_ptr<const std::string>> getRecords() const;
+
+		~RingSink() = default;
+	};
+
+	/**
+	 * @brief Named argument of logging call. Settings::jsonLog writes it as own typed field of record, {} in message formats its value. Create with Log::field
+	 */
+	template<typename T>
+	struct Field
+	{
+		std::string_view name;
+		T value; /// Arithmetic value, std::string_view of string or reference to other value
+	};
+
+	/**
+	 * @brief All configuration parameters
+	 */
+	struct Settings
+	{
+		DateFormat logDateFormat = DateFormat::DMY; /// One of DMY, MDY, YMD
+		std::filesystem::path pathToLogs; /// Path to logs folder. Empty for current_path/logs
+		uintmax_t logFileSize = Log::logFileSize; /// Size of each log file in bytes
+		uint64_t flags = AdditionalInformation::utcDate | AdditionalInformation::processName | AdditionalInformation::processId; /// Log::AdditionalInformation fields with bitwise OR(|) for multiple values
+		VerbosityLevel verbosityLevel = VerbosityLevel::verbose; /// Verbosity level for logging
+		std::unordered_map<std::string, VerbosityLevel> categoryVerbosityLevels; /// Verbosity levels of categories that replace verbosityLevel for them
+		WriteMode writeMode = WriteMode::synchronous; /// Write records on caller thread or on background thread
+		size_t queueCapacity = Log::defaultQueueCapacity; /// Maximum number of records waiting for background thread
+		BackpressurePolicy backpressurePolicy = BackpressurePolicy::block; /// What happens with record when queue is full
+		VerbosityLevel backpressureLevel = VerbosityLevel::error; /// Records at or above this level are never dropped by BackpressurePolicy::dropBelowLevel
+		size_t overflowCapacity = Log::defaultOverflowCapacity; /// Maximum number of records in overflow buffer
+		ThreadIdFormat threadIdFormat = ThreadIdFormat::standard; /// Thread identifier for threadId field
+		FileBackend fileBackend = FileBackend::stream; /// How records are written to log file
+		size_t batchSize = Log::defaultBatchSize; /// Buffer size in bytes for FileBackend::batched and FileBackend::uring
+		FlushPolicy flushPolicy; /// When log file is flushed
+		std::optional<VerbosityLevel> durableLevel; /// Records at or above this level are on stable storage before logging call returns. Empty to disable durable mode
+		std::chrono::microseconds durableMaxWait = std::chrono::microseconds(0); /// How long sync waits for concurrent durable records to share it
+		bool prepareNextLogFile = false; /// Create and open next log file on background thread so rotation only swaps file handles
+		bool preallocateLogFiles = false; /// Reserve logFileSize bytes on disk for prepared log files (fallocate on Linux)
+		bool compressRotatedLogFiles = false; /// Compress rotated log files on low priority background thread into independent 1 MiB frames with .index of frame offsets. .zst with zstd or .gz with zlib found at configure time, ignored without them
+		RetentionPolicy retentionPolicy; /// Limits for total size, age and number of log files. Without limits log files are never removed
+		bool binaryLog = false; /// Write call site, timestamp and raw arguments into .binlog files without formatting. Decode with log-decode. Always uses FileBackend::stream, sinks are not written
+		std::string layout; /// Record layout with %utc, %local, %pname, %pid, %tid, %cat, %lvl, %msg fields and %% for %. Empty for layout from flags
+		bool jsonLog = false; /// Write each record as one JSON object per line with utc, local, process, pid, tid fields from flags, category, level, message and Log::field arguments. layout is ignored, binaryLog takes precedence
+	};
+
+	/**
+	 * @brief Independent logger with own log files, rotation size, flags and verbosity levels, for example access or audit log. Static functions write into default logger. Asynchronous loggers share one record writer thread, other background threads belong to each logger
+	 */
+	class LOG_API Logger
+	{
+	private:
+		std::unique_ptr<Log> log;
+
+	public:
+		/**
+		 * @param settings All configuration parameters. Settings::pathToLogs must not be used by other logger
+		 * @exception std::runtime_error Settings::pathToLogs is used by other logger or is current_path/logs reserved for default logger that is not created yet
+		 */
+		Logger(const Settings& settings);
+
+		Logger(const Logger&) = delete;
+
+		Logger(Logger&&) noexcept = default;
+
+		Logger& operator = (const Logger&) = delete;
+
+		Logger& operator = (Logger&&) noexcept = default;
+
+		/**
+		 * @brief Log some information
+		 * @tparam ...Args
+		 * @param format Information with {} brackets for insertions. Checked at compile time
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename... Args>
+		void info(std::format_string<Args...> format, Category category, Args&&... args);
+
+		/**
+		 * @brief Log some information
+		 * @tparam ...Args
+		 * @param format Information with {} brackets for insertions. Runtime string, std::format_error on wrong format
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+		void info(const FormatT& format, Category category, Args&&... args);
+
+		/**
+		 * @brief Log some warning message
+		 * @tparam ...Args
+		 * @param format Warning message with {} brackets for insertions. Checked at compile time
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename... Args>
+		void warning(std::format_string<Args...> format, Category category, Args&&... args);
+
+		/**
+		 * @brief Log some warning message
+		 * @tparam ...Args
+		 * @param format Warning message with {} brackets for insertions. Runtime string, std::format_error on wrong format
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+		void warning(const FormatT& format, Category category, Args&&... args);
+
+		/**
+		 * @brief Log some error
+		 * @tparam ...Args
+		 * @param format Error message with {} brackets for insertions. Checked at compile time
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename... Args>
+		void error(std::format_string<Args...> format, Category category, Args&&... args);
+
+		/**
+		 * @brief Log some error
+		 * @tparam ...Args
+		 * @param format Error message with {} brackets for insertions. Runtime string, std::format_error on wrong format
+		 * @param category Log category
+		 * @param ...args Insertions
+		 */
+		template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+		void error(const FormatT& format, Category category, Args&&... args);
+
+		/**
+		 * @brief Same as Log::setVerbosityLevel for this logger
+		 */
+		void setVerbosityLevel(VerbosityLevel level);
+
+		/**
+		 * @brief Same as Log::setVerbosityLevel for category of this logger
+		 * @exception std::runtime_error 256 other categories already had levels in any logger
+		 */
+		void setVerbosityLevel(std::string_view category, VerbosityLevel level);
+
+		void resetVerbosityLevel(std::string_view category);
+
+		void addSink(const std::shared_ptr<Sink>& sink);
+
+		bool removeSink(const std::shared_ptr<Sink>& sink);
+
+		/**
+		 * @brief Wait until all records of this logger are written to log file and sinks and flush them
+		 */
+		void flush();
+
+		/**
+		 * @brief Wait until all records of this logger are on stable storage. Only syncs with Settings::durableLevel, otherwise same as flush
+		 */
+		void sync();
+
+		DurabilityStatistics getDurabilityStatistics() const;
+
+		/**
+		 * @brief Same as Log::getCurrentLogFilePath for this logger
+		 */
+		std::filesystem::path getCurrentLogFilePath() const;
+
+		/**
+		 * @brief Same as Log::getFileBackend for this logger
+		 */
+		FileBackend getFileBackend() const;
+
+		/**
+		 * @brief Writes all records before return
+		 */
+		~Logger();
+	};
+
 private:
 	std::ofstream logFile;
 	std::mutex writeMutex;
 	std::filesystem::path currentLogFilePath;
+	std::chrono::system_clock::time_point nextDayDeadline;
+	std::string indexedDate;
+	std::vector<LogSegment> resumableSegments;
+	std::unique_ptr<SegmentPreparer> segmentPreparer;
+	std::unique_ptr<SegmentCompressor> segmentCompressor;
+	std::unique_ptr<RetentionEnforcer> retentionEnforcer;
+	std::unique_ptr<SinkDispatcher> sinkDispatcher;
+	std::unique_ptr<SuppressionReporter> suppressionReporter;
 	std::filesystem::path basePath;
 	std::filesystem::path executablePath;
-	std::vector<std::function<std::string()>> modifiers;
+	std::vector<LayoutSegment> layout;
 	uint64_t flags;
 	int64_t executableProcessId;
 	size_t currentLogFileSize;
-	std::ostream* outputStream;
-	std::ostream* errorStream;
+	uintmax_t maxLogFileSize;
 	DateFormat logDateFormat;
+	ThreadIdFormat threadIdFormat;
 	std::atomic<VerbosityLevel> verbosityLevel;
+	std::atomic<int> lowestVerbosityLevel;
+	std::atomic<bool> hasCategoryLevels;
+	std::array<std::atomic<uint8_t>, Log::maxCategoryLevels> categoryLevels; /// 0 for verbosityLevel, otherwise VerbosityLevel + 1
+	std::mutex categoryMutex;
+	FlushPolicy flushPolicy;
+	size_t unflushedSize;
+	std::chrono::steady_clock::time_point lastFlushTime;
+	std::unique_ptr<FlushTimer> flushTimer;
+	std::atomic<uint64_t> writtenRecords;
+	std::optional<VerbosityLevel> durableLevel;
+	std::unique_ptr<DurableSync> durableSync;
+	std::unique_ptr<BatchedFileWriter> batchedFileWriter;
+	std::unique_ptr<MappedSegmentWriter> mappedSegmentWriter;
+	std::unique_ptr<UringFileWriter> uringFileWriter;
+	FileBackend fileBackend;
+	std::unique_ptr<BinaryLog> binaryLog;
+	std::string_view logFileExtension;
+	std::unique_ptr<RecordQueue> queue;
+	std::shared_ptr<SharedWriter> sharedWriter;
 
 private:
 	static DateFormat dateFormatFromString(const std::string& source);
 
 	static std::string_view getLocalTimeZoneName();
 
-	bool verbosityFilter(Level level);
+	static std::string_view getLevelName(Level level);
 
-	void write(const std::string& data, Level type);
+	static std::string layoutFromFlags(uint64_t flags);
 
-	void nextLogFile();
+	static bool checkLevel(Level level, VerbosityLevel threshold);
+
+	static void appendFullDate(std::string& buffer, DateFormat logDateFormat, std::chrono::seconds sinceEpoch);
+
+	static std::chrono::seconds getLocalTimeZoneOffset(std::chrono::sys_seconds now);
+
+	static uint32_t getCallSite(std::string_view format, bool staticFormat);
+
+	static uint32_t getBinaryThread(const Log& log);
+
+	static uint32_t getCategoryId(std::string_view category);
+
+	template<typename T>
+	static void appendBinary(std::string& buffer, const T& value);
+
+	template<typename T>
+	static void appendBinaryArgument(std::string& buffer, const T& value);
+
+	template<typename T>
+	struct IsField : std::false_type {};
+
+	template<typename T>
+	struct IsField<Field<T>> : std::true_type {};
+
+	/**
+	 * @brief Append text as escaped JSON string with quotation marks
+	 */
+	static void appendJsonString(std::string& buffer, std::string_view text);
+
+	/**
+	 * @brief Escape text appended to buffer after start in place
+	 */
+	static void escapeJsonString(std::string& buffer, size_t start);
 
-	void newLogFolder();
+	template<typename T>
+	static void appendJsonValue(std::string& buffer, const T& value);
 
-	bool checkDate() const;
+	template<typename T>
+	static void appendJsonField(std::string& buffer, const T& value);
 
-	bool checkFileSize(const std::filesystem::path& filePath) const;
+	bool verbosityFilter(Level level, Category category) const;
+
+	bool categoryFilter(Level level, Category category) const;
+
+	void setCategoryLevel(std::string_view category, uint8_t level);
+
+	void setLevel(VerbosityLevel level);
+
+	void attachSink(const std::shared_ptr<Sink>& sink);
+
+	bool detachSink(const std::shared_ptr<Sink>& sink);
+
+	void flushRecords();
+
+	/**
+	 * @brief Copy of currentLogFilePath under writeMutex
+	 */
+	std::filesystem::path getLogFilePath();
+
+	void syncRecords();
+
+	bool admit(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, Level type, std::string_view category);
+
+	void writeSuppressedSummary(Level type, std::string_view category, uint64_t suppressed);
+
+	void updateLowestVerbosityLevel();
+
+	void write(std::string_view data, Level type);
+
+	void writeRecord(std::string_view data, Level type);
+
+	void writeBinaryRecord(std::string_view data);
+
+	void writeTextRecord(std::string_view data, Level type);
+
+	void writeMapped(std::string_view data, Level type);
+
+	bool checkFlush(Level type) const;
+
+	void flushLogFile();
+
+	void flushStreams();
+
+	/**
+	 * @brief Flush if FlushPolicy::interval passed since last flush
+	 * @return When to check again
+	 */
+	std::chrono::steady_clock::time_point flushExpired();
+
+	/**
+	 * @brief Write up to maxRecords queued records. Writes summary of dropped records when queue is empty
+	 * @return false if queue was empty
+	 */
+	bool consumeRecords(size_t maxRecords);
+
+	void writeDroppedSummary();
+
+	void joinSharedWriter(const Settings& settings);
+
+	void leaveSharedWriter();
+
+	std::ios::openmode getLogFileOpenMode() const;
+
+	void nextLogFile();
+
+	std::filesystem::path newLogFilePath(const std::string& currentDate) const;
+
+	void indexLogFolder(const std::string& currentDate);
 
 	std::string getCurrentDate() const;
 
 	std::string getFullCurrentDateFileName() const;
 
-	std::string getFullCurrentDateUTC() const;
+	void appendFullCurrentDateUTC(std::string& buffer) const;
+
+	void appendFullCurrentDateLocal(std::string& buffer) const;
 
-	std::string getFullCurrentDateLocal() const;
+	void appendThreadId(std::string& buffer) const;
 
-	std::string getProcessName() const;
+	void appendIsoCurrentDateUTC(std::string& buffer) const;
 
-	std::string getProcessId() const;
+	void appendIsoCurrentDateLocal(std::string& buffer) const;
 
-	std::string getThreadId() const;
+	void appendJsonThreadId(std::string& buffer) const;
 
-	void initModifiers(uint64_t flags);
+	void initLayout(std::string_view pattern);
+
+	void initJsonLayout();
 
 	void initExecutableInformation();
 
-	void init
-	(
-		DateFormat logDateFormat = DateFormat::DMY,
-		const std::filesystem::path& pathToLogs = "",
-		uintmax_t defaultLogFileSize = Log::logFileSize,
-		uint64_t flags = AdditionalInformation::utcDate | AdditionalInformation::processName | AdditionalInformation::processId,
-		VerbosityLevel verbosityLevel = VerbosityLevel::verbose
-	);
+	/**
+	 * @param defaultLogger Logger of static functions, only it can use current_path/logs before it is created
+	 */
+	void init(const Settings& settings, bool defaultLogger);
 
 private:
 	Log();
 
-	Log(DateFormat logDateFormat, const std::filesystem::path& pathToLogs, uintmax_t defaultLogFileSize, uint64_t flags, VerbosityLevel verbosityLevel);
+	Log(const Settings& settings, bool defaultLogger);
 
 	Log(const Log&) = delete;
 
@@ -168,12 +916,38 @@ private:
 
 	Log& operator = (Log&&) noexcept = delete;
 
-	~Log() = default;
+	~Log();
 
 	friend struct std::default_delete<Log>;
 
 private:
+	/**
+	 * @brief Thread local record buffer. Record logged by formatter of other record gets own buffer
+	 */
+	class LOG_API RecordBuffer
+	{
+	private:
+		std::string nested;
+		std::string* buffer;
+
+	public:
+		RecordBuffer();
+
+		std::string& get();
+
+		~RecordBuffer();
+	};
+
+private:
+	static std::string& getRecordBuffer();
+
 	template<typename... Args>
+	void makeRecord(std::string& buffer, Level type, std::string_view format, std::string_view category, Args&&... args);
+
+	template<bool staticFormat, typename... Args>
+	void makeBinaryRecord(std::string& buffer, Level type, std::string_view format, std::string_view category, Args&&... args);
+
+	template<bool staticFormat = true, typename... Args>
 	void log(Level type, std::string_view format, std::string_view category, Args&&... args);
 
 public:
@@ -185,7 +959,7 @@ public:
 	Log& operator +=(const std::string& message);
 
 	/**
-	 * @brief Get logger instance
+	 * @brief Get default logger instance
 	 * @return 
 	 */
 	static Log& getInstance();
@@ -238,20 +1012,47 @@ public:
 	);
 
 	/**
-	 * @brief Also output log information into stream
+	* @brief Additional configuration
+	* @param settings All configuration parameters
+	*/
+	static void configure(const Settings& settings);
+
+	/**
+	 * @brief Also output log information into stream. Stream is written on its own thread like Sink, records are dropped if stream can't keep up
 	 * @param outputStream
 	 */
 	static void duplicateLog(std::ostream& outputStream);
 
 	/**
-	 * @brief Also output log error information into stream
+	 * @brief Also output log error information into stream. Stream is written on its own thread like Sink, records are dropped if stream can't keep up
 	 * @param errorStream
 	 */
 	static void duplicateErrorLog(std::ostream& errorStream);
 
 	/**
-	 * @brief Is logger is valid
-	 * @return 
+	 * @brief Also write text records at or above sink level into sink. Each record is formatted once and shared by all sinks
+	 * @param sink
+	 */
+	static void addSink(const std::shared_ptr<Sink>& sink);
+
+	/**
+	 * @brief Write all records waiting for sink and stop writing into it
+	 * @param sink
+	 * @return false if sink wasn't added
+	 */
+	static bool removeSink(const std::shared_ptr<Sink>& sink);
+
+	/**
+	 * @brief Named argument, for example Log::info("Request done", "Http", Log::field("status", 200)). Text records only contain fields used by {} in message
+	 * @param name Key of JSON field
+	 * @param value Arithmetic, string or formattable value. Must live until logging call returns
+	 */
+	template<typename T>
+	static auto field(std::string_view name, const T& value);
+
+	/**
+	 * @brief Is logger is valid
+	 * @return 
 	 */
 	static bool isValid();
 
@@ -262,9 +1063,50 @@ public:
 	static void setVerbosityLevel(VerbosityLevel level);
 
 	/**
-	 * @brief Get current log file path
+	 * @brief Sets verbosity level of category, it replaces global verbosity level for this category
+	 * @param category Log category
+	 * @param level The verbosity level to set
+	 * @exception std::runtime_error 256 other categories already had levels in any logger
 	 */
-	static const std::filesystem::path& getCurrentLogFilePath();
+	static void setVerbosityLevel(std::string_view category, VerbosityLevel level);
+
+	/**
+	 * @brief Filter category with global verbosity level again
+	 * @param category Log category
+	 */
+	static void resetVerbosityLevel(std::string_view category);
+
+	/**
+	 * @brief Write name instead of thread id for calling thread
+	 * @param name Thread name, for example io-worker-3. Empty to restore thread id
+	 */
+	static void setThreadName(std::string_view name);
+
+	/**
+	 * @brief Convert .binlog file into text records with layout of process that wrote it
+	 * @exception std::runtime_error Corrupted input
+	 */
+	static void decodeBinaryLog(std::istream& input, std::ostream& output);
+
+	/**
+	 * @brief Wait until all logged records are written to log file and sinks and flush them
+	 */
+	static void flush();
+
+	/**
+	 * @brief Wait until all logged records are on stable storage. Only syncs with Settings::durableLevel, otherwise same as flush
+	 */
+	static void sync();
+
+	/**
+	 * @brief How many records each sync covered. Zeros without Settings::durableLevel
+	 */
+	static DurabilityStatistics getDurabilityStatistics();
+
+	/**
+	 * @brief Get current log file path. Copy, because writer thread may change it during rotation
+	 */
+	static std::filesystem::path getCurrentLogFilePath();
 
 	/**
 	 * @brief Get path to executable
@@ -278,118 +1120,718 @@ public:
 	 */
 	static int64_t getExecutableProcessId();
 
+	/**
+	 * @brief Backend that writes log file. Differs from Settings::fileBackend when backend isn't available on this system
+	 */
+	static FileBackend getFileBackend();
+
+	/**
+	 * @brief Extension of compressed log files. Empty if Settings::compressRotatedLogFiles is ignored because zstd and zlib were not found at configure time
+	 */
+	static std::string_view getCompressedLogFileExtension();
+
 	/**
 	 * @brief Log some information
 	 * @tparam ...Args
-	 * @param format Information with {} brackets for insertions
+	 * @param format Information with {} brackets for insertions. Checked at compile time
 	 * @param category Log category
 	 * @param ...args Insertions
 	 */
 	template<typename... Args>
-	static void info(std::string_view format, std::string_view category, Args&&... args);
+	static void info(std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log some information
+	 * @tparam ...Args
+	 * @param format Information with {} brackets for insertions. Runtime string, std::format_error on wrong format
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+	static void info(const FormatT& format, Category category, Args&&... args);
 
 	/**
 	 * @brief Log some warning message
 	 * @tparam ...Args
-	 * @param format Warning message with {} brackets for insertions
+	 * @param format Warning message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void warning(std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log some warning message
+	 * @tparam ...Args
+	 * @param format Warning message with {} brackets for insertions. Runtime string, std::format_error on wrong format
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+	static void warning(const FormatT& format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log some error
+	 * @tparam ...Args
+	 * @param format Error message with {} brackets for insertions. Checked at compile time
 	 * @param category Log category
 	 * @param ...args Insertions
 	 */
 	template<typename... Args>
-	static void warning(std::string_view format, std::string_view category, Args&&... args);
+	static void error(std::format_string<Args...> format, Category category, Args&&... args);
 
 	/**
 	 * @brief Log some error
 	 * @tparam ...Args
-	 * @param format Error message with {} brackets for insertions
+	 * @param format Error message with {} brackets for insertions. Runtime string, std::format_error on wrong format
 	 * @param category Log category
 	 * @param ...args Insertions
 	 */
+	template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+	static void error(const FormatT& format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log and exit
+	 * @tparam ...Args
+	 * @param format Fatal error message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param exitCode Exit code
+	 * @param ...args
+	 */
 	template<typename... Args>
-	static void error(std::string_view format, std::string_view category, Args&&... args);
+	static void fatalError(std::format_string<Args...> format, Category category, int exitCode, Args&&... args);
 
 	/**
 	 * @brief Log and exit
 	 * @tparam ...Args
-	 * @param format Fatal error message with {} brackets for insertions
+	 * @param format Fatal error message with {} brackets for insertions. Runtime string, std::format_error on wrong format
 	 * @param category Log category
 	 * @param exitCode Exit code
 	 * @param ...args
 	 */
+	template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+	static void fatalError(const FormatT& format, Category category, int exitCode, Args&&... args);
+
+	/**
+	 * @brief Log first and every n-th information of call site
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_INFO_EVERY declares it
+	 * @param n Log every n-th call
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void infoEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log at most count informations of call site per period. Suppressed messages are reported with one summary record
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_INFO_LIMITED declares it
+	 * @param count Number of records per period
+	 * @param period Steady clock period, counting starts again when it ends
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void infoLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log first and every n-th warning message of call site
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_WARNING_EVERY declares it
+	 * @param n Log every n-th call
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void warningEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log at most count warning messages of call site per period. Suppressed messages are reported with one summary record
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_WARNING_LIMITED declares it
+	 * @param count Number of records per period
+	 * @param period Steady clock period, counting starts again when it ends
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
 	template<typename... Args>
-	static void fatalError(std::string_view format, std::string_view category, int exitCode, Args&&... args);
+	static void warningLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log first and every n-th error of call site
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_ERROR_EVERY declares it
+	 * @param n Log every n-th call
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void errorEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args);
+
+	/**
+	 * @brief Log at most count errors of call site per period. Suppressed messages are reported with one summary record
+	 * @tparam ...Args
+	 * @param site Static state of call site, LOG_ERROR_LIMITED declares it
+	 * @param count Number of records per period
+	 * @param period Steady clock period, counting starts again when it ends
+	 * @param format Message with {} brackets for insertions. Checked at compile time
+	 * @param category Log category
+	 * @param ...args Insertions
+	 */
+	template<typename... Args>
+	static void errorLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args);
 };
 
+inline bool Log::verbosityFilter(Level level, Category category) const
+{
+	static_assert(static_cast<int>(Level::info) == static_cast<int>(VerbosityLevel::verbose));
+	static_assert(static_cast<int>(Level::warning) == static_cast<int>(VerbosityLevel::warning));
+	static_assert(static_cast<int>(Level::error) == static_cast<int>(VerbosityLevel::error));
+
+	// Lowest of global and category levels, without category levels it is global level
+	if (static_cast<int>(level) < lowestVerbosityLevel.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	return !hasCategoryLevels.load(std::memory_order_relaxed) || this->categoryFilter(level, category);
+}
+
+inline bool Log::EverySite::sample(uint64_t n)
+{
+	return n < 2 || !(calls.fetch_add(1, std::memory_order_relaxed) % n);
+}
+
+template<typename T, typename CharT>
+struct std::formatter<Log::Field<T>, CharT> : std::formatter<std::remove_cvref_t<T>, CharT>
+{
+	template<typename FormatContext>
+	auto format(const Log::Field<T>& field, FormatContext& context) const
+	{
+		return std::formatter<std::remove_cvref_t<T>, CharT>::format(field.value, context);
+	}
+};
+
+template<typename T>
+auto Log::field(std::string_view name, const T& value)
+{
+	if constexpr (std::is_arithmetic_v<T>)
+	{
+		return Field<T>{ name, value };
+	}
+	else if constexpr (std::is_convertible_v<const T&, std::string_view> && !std::is_null_pointer_v<T>)
+	{
+		return Field<std::string_view>{ name, value };
+	}
+	else
+	{
+		return Field<const T&>{ name, value };
+	}
+}
+
 template<typename... Args>
-void Log::info(std::string_view format, std::string_view category, Args&&... args)
+void Log::info(std::format_string<Args...> format, Category category, Args&&... args)
 {
-	Log::getInstance().log(Level::info, format, category, std::forward<Args>(args)...);
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::info, category))
+	{
+		return;
+	}
+
+	logger.log(Level::info, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::info(const FormatT& format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::info, category))
+	{
+		return;
+	}
+
+	logger.log<false>(Level::info, format, category, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-void Log::warning(std::string_view format, std::string_view category, Args&&... args)
+void Log::warning(std::format_string<Args...> format, Category category, Args&&... args)
 {
-	Log::getInstance().log(Level::warning, format, category, std::forward<Args>(args)...);
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::warning, category))
+	{
+		return;
+	}
+
+	logger.log(Level::warning, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::warning(const FormatT& format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::warning, category))
+	{
+		return;
+	}
+
+	logger.log<false>(Level::warning, format, category, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-void Log::error(std::string_view format, std::string_view category, Args&&... args)
+void Log::error(std::format_string<Args...> format, Category category, Args&&... args)
 {
-	Log::getInstance().log(Level::error, format, category, std::forward<Args>(args)...);
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::error, category))
+	{
+		return;
+	}
+
+	logger.log(Level::error, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::error(const FormatT& format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::error, category))
+	{
+		return;
+	}
+
+	logger.log<false>(Level::error, format, category, std::forward<Args>(args)...);
 }
 
 template<typename... Args>
-void Log::fatalError(std::string_view format, std::string_view category, int exitCode, Args&&... args)
+void Log::fatalError(std::format_string<Args...> format, Category category, int exitCode, Args&&... args)
+{
+	Log::getInstance().log(Level::fatalError, format.get(), category, std::forward<Args>(args)...);
+
+	exit(exitCode);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::fatalError(const FormatT& format, Category category, int exitCode, Args&&... args)
 {
-	Log::getInstance().log(Level::fatalError, format, category, std::forward<Args>(args)...);
+	Log::getInstance().log<false>(Level::fatalError, format, category, std::forward<Args>(args)...);
 
 	exit(exitCode);
 }
 
 template<typename... Args>
-void Log::log(Level type, std::string_view format, std::string_view category, Args&&... args)
+void Log::infoEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::info, category) || !site.sample(n))
+	{
+		return;
+	}
+
+	logger.log(Level::info, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::infoLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::info, category) || !logger.admit(site, count, period, Level::info, category))
+	{
+		return;
+	}
+
+	logger.log(Level::info, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::warningEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::warning, category) || !site.sample(n))
+	{
+		return;
+	}
+
+	logger.log(Level::warning, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::warningLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::warning, category) || !logger.admit(site, count, period, Level::warning, category))
+	{
+		return;
+	}
+
+	logger.log(Level::warning, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::errorEvery(EverySite& site, uint64_t n, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::error, category) || !site.sample(n))
+	{
+		return;
+	}
+
+	logger.log(Level::error, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::errorLimited(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, std::format_string<Args...> format, Category category, Args&&... args)
+{
+	Log& logger = Log::getInstance();
+
+	if (!logger.verbosityFilter(Level::error, category) || !logger.admit(site, count, period, Level::error, category))
+	{
+		return;
+	}
+
+	logger.log(Level::error, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::Logger::info(std::format_string<Args...> format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::info, category))
+	{
+		return;
+	}
+
+	log->log(Level::info, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::Logger::info(const FormatT& format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::info, category))
+	{
+		return;
+	}
+
+	log->log<false>(Level::info, format, category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::Logger::warning(std::format_string<Args...> format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::warning, category))
+	{
+		return;
+	}
+
+	log->log(Level::warning, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::Logger::warning(const FormatT& format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::warning, category))
+	{
+		return;
+	}
+
+	log->log<false>(Level::warning, format, category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::Logger::error(std::format_string<Args...> format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::error, category))
+	{
+		return;
+	}
+
+	log->log(Level::error, format.get(), category, std::forward<Args>(args)...);
+}
+
+template<typename FormatT, typename... Args> requires Log::isRuntimeFormat<FormatT>
+void Log::Logger::error(const FormatT& format, Category category, Args&&... args)
+{
+	if (!log->verbosityFilter(Level::error, category))
+	{
+		return;
+	}
+
+	log->log<false>(Level::error, format, category, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+void Log::makeRecord(std::string& buffer, Level type, std::string_view format, std::string_view category, Args&&... args)
+{
+	for (const LayoutSegment& segment : layout)
+	{
+		switch (segment.operation)
+		{
+		case LayoutOperation::text:
+			buffer += segment.text;
+
+			break;
+
+		case LayoutOperation::utcDate:
+			this->appendFullCurrentDateUTC(buffer);
+
+			break;
+
+		case LayoutOperation::localDate:
+			this->appendFullCurrentDateLocal(buffer);
+
+			break;
+
+		case LayoutOperation::threadId:
+			this->appendThreadId(buffer);
+
+			break;
+
+		case LayoutOperation::category:
+			buffer += category;
+
+			break;
+
+		case LayoutOperation::level:
+			buffer += Log::getLevelName(type);
+
+			break;
+
+		case LayoutOperation::message:
+			std::vformat_to(std::back_inserter(buffer), format, std::make_format_args(args...));
+
+			break;
+
+		case LayoutOperation::isoUtcDate:
+			this->appendIsoCurrentDateUTC(buffer);
+
+			break;
+
+		case LayoutOperation::isoLocalDate:
+			this->appendIsoCurrentDateLocal(buffer);
+
+			break;
+
+		case LayoutOperation::jsonThreadId:
+			this->appendJsonThreadId(buffer);
+
+			break;
+
+		case LayoutOperation::jsonCategory:
+			Log::appendJsonString(buffer, category);
+
+			break;
+
+		case LayoutOperation::jsonMessage:
+		{
+			buffer += '"';
+
+			// Message is formatted once, escaping only moves text after first escaped character
+			size_t start = buffer.size();
+
+			std::vformat_to(std::back_inserter(buffer), format, std::make_format_args(args...));
+
+			Log::escapeJsonString(buffer, start);
+
+			buffer += '"';
+
+			break;
+		}
+
+		case LayoutOperation::jsonFields:
+			(Log::appendJsonField(buffer, args), ...);
+
+			break;
+		}
+	}
+}
+
+template<typename T>
+void Log::appendJsonValue(std::string& buffer, const T& value)
 {
-	std::string result = std::vformat(format, std::make_format_args(args...));
-	std::string additionalInformation;
+	using ValueT = std::remove_cvref_t<T>;
 
-	additionalInformation.reserve(Log::additionalInformationSize);
+	if constexpr (std::is_same_v<ValueT, bool>)
+	{
+		buffer += value ? "true" : "false";
+	}
+	else if constexpr (std::is_same_v<ValueT, char>)
+	{
+		Log::appendJsonString(buffer, std::string_view(&value, 1));
+	}
+	else if constexpr (std::is_integral_v<ValueT>)
+	{
+		std::format_to(std::back_inserter(buffer), "{}", value);
+	}
+	else if constexpr (std::is_floating_point_v<ValueT>)
+	{
+		if (std::isfinite(value))
+		{
+			std::format_to(std::back_inserter(buffer), "{}", value);
+		}
+		else
+		{
+			buffer += "null";
+		}
+	}
+	else if constexpr (std::is_convertible_v<const ValueT&, std::string_view> && !std::is_null_pointer_v<ValueT>)
+	{
+		Log::appendJsonString(buffer, std::string_view(value));
+	}
+	else
+	{
+		Log::appendJsonString(buffer, std::format("{}", value));
+	}
+}
 
-	for (const auto& modifier : modifiers)
+template<typename T>
+void Log::appendJsonField(std::string& buffer, const T& value)
+{
+	if constexpr (IsField<std::remove_cvref_t<T>>::value)
 	{
-		additionalInformation += modifier();
+		buffer += ',';
+
+		Log::appendJsonString(buffer, value.name);
+
+		buffer += ':';
+
+		Log::appendJsonValue(buffer, value.value);
 	}
+}
+
+template<typename T>
+void Log::appendBinary(std::string& buffer, const T& value)
+{
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+void Log::appendBinaryArgument(std::string& buffer, const T& value)
+{
+	using ValueT = std::remove_cvref_t<T>;
 
-	additionalInformation += std::format(" {}: ", category);
+	if constexpr (IsField<ValueT>::value)
+	{
+		// Decoder formats value with specification of message, name is only written to JSON records
+		Log::appendBinaryArgument(buffer, value.value);
+	}
+	else if constexpr (std::is_same_v<ValueT, bool>)
+	{
+		buffer += static_cast<char>(BinaryArgument::boolean);
+		buffer += static_cast<char>(value);
+	}
+	else if constexpr (std::is_same_v<ValueT, char>)
+	{
+		buffer += static_cast<char>(BinaryArgument::character);
+		buffer += value;
+	}
+	else if constexpr (std::is_integral_v<ValueT> && std::is_signed_v<ValueT>)
+	{
+		buffer += static_cast<char>(BinaryArgument::signedInteger);
 
-	switch (type)
+		Log::appendBinary(buffer, static_cast<int64_t>(value));
+	}
+	else if constexpr (std::is_integral_v<ValueT>)
 	{
-	case Level::info:
-		additionalInformation += "INFO";
+		buffer += static_cast<char>(BinaryArgument::unsignedInteger);
 
-		break;
+		Log::appendBinary(buffer, static_cast<uint64_t>(value));
+	}
+	else if constexpr (std::is_same_v<ValueT, float>)
+	{
+		buffer += static_cast<char>(BinaryArgument::singleFloatingPoint);
 
-	case Level::warning:
-		additionalInformation += "WARNING";
+		Log::appendBinary(buffer, value);
+	}
+	else if constexpr (std::is_same_v<ValueT, long double>)
+	{
+		buffer += static_cast<char>(BinaryArgument::extendedFloatingPoint);
+		buffer += static_cast<char>(sizeof(long double));
 
-		break;
+		Log::appendBinary(buffer, value);
+	}
+	else if constexpr (std::is_floating_point_v<ValueT>)
+	{
+		buffer += static_cast<char>(BinaryArgument::floatingPoint);
 
-	case Level::error:
-		additionalInformation += "ERROR";
+		Log::appendBinary(buffer, static_cast<double>(value));
+	}
+	else if constexpr (std::is_convertible_v<const ValueT&, std::string_view> && !std::is_null_pointer_v<ValueT>)
+	{
+		std::string_view text(value);
 
-		break;
+		buffer += static_cast<char>(BinaryArgument::string);
 
-	case Level::fatalError:
-		additionalInformation += "FATAL_ERROR";
+		Log::appendBinary(buffer, static_cast<uint32_t>(text.size()));
 
-		break;
+		buffer += text;
+	}
+	else if constexpr (std::is_pointer_v<ValueT> || std::is_null_pointer_v<ValueT>)
+	{
+		buffer += static_cast<char>(BinaryArgument::pointer);
 
-	default:
-		throw std::runtime_error("Wrong level type");
+		Log::appendBinary(buffer, reinterpret_cast<uint64_t>(static_cast<const void*>(value)));
+	}
+	else
+	{
+		// Other formattable types are formatted on caller thread
+		Log::appendBinaryArgument(buffer, std::format("{}", value));
 	}
+}
+
+template<bool staticFormat, typename... Args>
+void Log::makeBinaryRecord(std::string& buffer, Level type, std::string_view format, std::string_view category, Args&&... args)
+{
+	buffer += static_cast<char>(BinaryEntry::record);
+
+	Log::appendBinary(buffer, uint32_t(0));
+	Log::appendBinary(buffer, Log::getCallSite(format, staticFormat));
+	Log::appendBinary(buffer, Log::getBinaryThread(*this));
+
+	buffer += static_cast<char>(type);
+
+	Log::appendBinary(buffer, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+	Log::appendBinary(buffer, static_cast<uint32_t>(category.size()));
+
+	buffer += category;
+	buffer += static_cast<char>(sizeof...(Args));
 
-	additionalInformation += ": ";
+	(Log::appendBinaryArgument(buffer, args), ...);
 
-	result.insert(result.begin(), additionalInformation.begin(), additionalInformation.end());
+	uint32_t size = static_cast<uint32_t>(buffer.size() - sizeof(BinaryEntry) - sizeof(uint32_t));
+
+	std::memcpy(buffer.data() + sizeof(BinaryEntry), &size, sizeof(size));
+}
+
+template<bool staticFormat, typename... Args>
+void Log::log(Level type, std::string_view format, std::string_view category, Args&&... args)
+{
+	RecordBuffer recordBuffer;
+	std::string& buffer = recordBuffer.get();
+
+	buffer.clear();
+
+	if (binaryLog)
+	{
+		this->makeBinaryRecord<staticFormat>(buffer, type, format, category, std::forward<Args>(args)...);
+	}
+	else
+	{
+		this->makeRecord(buffer, type, format, category, std::forward<Args>(args)...);
+	}
 
-	this->write(result, type);
+	this->write(buffer, type);
 }
@@ -0,0 +1,178 @@
+#include "BatchedFileWriter.h"
+
+#ifdef __LINUX__
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+void Log::BatchedFileWriter::AlignedDelete::operator ()(char* pointer) const
+{
+	::operator delete[](pointer, std::align_val_t(bufferAlignment));
+}
+
+void Log::BatchedFileWriter::writeAll(const std::string_view* parts, size_t count)
+{
+	static constexpr size_t maxParts = 3;
+
+	iovec vectors[maxParts];
+	size_t first = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		vectors[i].iov_base = const_cast<char*>(parts[i].data());
+		vectors[i].iov_len = parts[i].size();
+	}
+
+	while (first < count)
+	{
+		ssize_t written = writev(descriptor, vectors + first, static_cast<int>(count - first));
+
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			std::cerr << "Can't write log file: " << std::strerror(errno) << std::endl;
+
+			return;
+		}
+
+		// Skip fully written parts and advance partially written one
+		while (first < count && static_cast<size_t>(written) >= vectors[first].iov_len)
+		{
+			written -= vectors[first].iov_len;
+
+			first++;
+		}
+
+		if (first < count)
+		{
+			vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + written;
+			vectors[first].iov_len -= written;
+		}
+	}
+}
+
+Log::BatchedFileWriter::BatchedFileWriter(size_t capacity) :
+	capacity((std::max<size_t>(capacity, 1) + bufferAlignment - 1) / bufferAlignment * bufferAlignment),
+	size(0),
+	descriptor(-1)
+{
+	buffer = std::unique_ptr<char[], AlignedDelete>(new (std::align_val_t(bufferAlignment)) char[this->capacity]);
+}
+
+void Log::BatchedFileWriter::open(const std::filesystem::path& logFilePath)
+{
+	this->flush();
+
+	if (descriptor != -1)
+	{
+		::close(descriptor);
+	}
+
+	descriptor = ::open(logFilePath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+	if (descriptor == -1)
+	{
+		throw std::runtime_error(std::format("Can't open {}: {}", logFilePath.string(), std::strerror(errno)));
+	}
+}
+
+size_t Log::BatchedFileWriter::append(std::string_view data)
+{
+	size_t result = data.size() + 1;
+
+	if (size + result > capacity)
+	{
+		if (result > capacity)
+		{
+			// Record doesn't fit into buffer, write everything with one call
+			std::string_view parts[] = { std::string_view(buffer.get(), size), data, "\n" };
+
+			this->writeAll(parts, std::size(parts));
+
+			size = 0;
+
+			return result;
+		}
+
+		this->flush();
+	}
+
+	std::memcpy(buffer.get() + size, data.data(), data.size());
+
+	buffer[size + data.size()] = '\n';
+
+	size += result;
+
+	return result;
+}
+
+void Log::BatchedFileWriter::flush()
+{
+	if (!size)
+	{
+		return;
+	}
+
+	std::string_view parts[] = { std::string_view(buffer.get(), size) };
+
+	this->writeAll(parts, std::size(parts));
+
+	size = 0;
+}
+
+Log::BatchedFileWriter::~BatchedFileWriter()
+{
+	this->flush();
+
+	if (descriptor != -1)
+	{
+		::close(descriptor);
+	}
+}
+#else
+void Log::BatchedFileWriter::AlignedDelete::operator ()(char* pointer) const
+{
+	::operator delete[](pointer, std::align_val_t(bufferAlignment));
+}
+
+void Log::BatchedFileWriter::writeAll(const std::string_view* parts, size_t count)
+{
+
+}
+
+Log::BatchedFileWriter::BatchedFileWriter(size_t capacity) :
+	capacity(capacity),
+	size(0),
+	descriptor(-1)
+{
+	throw std::runtime_error("FileBackend::batched is only available on POSIX systems");
+}
+
+void Log::BatchedFileWriter::open(const std::filesystem::path& logFilePath)
+{
+
+}
+
+size_t Log::BatchedFileWriter::append(std::string_view data)
+{
+	return 0;
+}
+
+void Log::BatchedFileWriter::flush()
+{
+
+}
+
+Log::BatchedFileWriter::~BatchedFileWriter()
+{
+
+}
+#endif
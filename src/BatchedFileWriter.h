@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Log.h"
+
+/**
+ * @brief Log file backend that collects records in aligned buffer and writes them with writev in big batches. POSIX only, constructor throws on other systems
+ */
+class Log::BatchedFileWriter
+{
+private:
+	static inline constexpr size_t bufferAlignment = 4096;
+
+	struct AlignedDelete
+	{
+		void operator ()(char* pointer) const;
+	};
+
+private:
+	std::unique_ptr<char[], AlignedDelete> buffer;
+	size_t capacity;
+	size_t size;
+	int descriptor;
+
+private:
+	void writeAll(const std::string_view* parts, size_t count);
+
+public:
+	/**
+	 * @param capacity Buffer size in bytes, rounded up to alignment
+	 */
+	BatchedFileWriter(size_t capacity);
+
+	/**
+	 * @brief Write buffered records and open logFilePath for appending
+	 */
+	void open(const std::filesystem::path& logFilePath);
+
+	/**
+	 * @brief Buffer record and line break. Writes buffer when it is full
+	 * @return Number of bytes appended to log file
+	 */
+	size_t append(std::string_view data);
+
+	/**
+	 * @brief Write buffered records
+	 */
+	void flush();
+
+	~BatchedFileWriter();
+};
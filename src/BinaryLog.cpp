@@ -0,0 +1,550 @@
+#include "BinaryLog.h"
+
+#include <deque>
+#include <limits>
+#include <charconv>
+#include <algorithm>
+#include <unordered_map>
+#include <variant>
+
+using BinaryValue = std::variant<bool, char, int64_t, uint64_t, float, double, long double, std::string_view, const void*>;
+
+/**
+ * @brief Bounds checked reader of entry payload
+ */
+class BinaryReader
+{
+private:
+	std::string_view data;
+
+public:
+	BinaryReader(std::string_view data) :
+		data(data)
+	{
+
+	}
+
+	template<typename T>
+	T read()
+	{
+		T result;
+
+		if (data.size() < sizeof(T))
+		{
+			throw std::runtime_error("Corrupted binary log entry");
+		}
+
+		std::memcpy(&result, data.data(), sizeof(T));
+
+		data.remove_prefix(sizeof(T));
+
+		return result;
+	}
+
+	std::string_view readString()
+	{
+		uint32_t size = this->read<uint32_t>();
+
+		if (data.size() < size)
+		{
+			throw std::runtime_error("Corrupted binary log entry");
+		}
+
+		std::string_view result = data.substr(0, size);
+
+		data.remove_prefix(size);
+
+		return result;
+	}
+};
+
+/**
+ * @brief Interned call site formats and rendered thread ids shared by all files
+ */
+struct BinaryRegistry
+{
+	std::mutex registryMutex;
+	std::unordered_map<std::string, uint32_t> callSiteIds;
+	std::deque<std::string> callSites;
+	std::unordered_map<std::string, uint32_t> threadIds;
+	std::deque<std::string> threads;
+};
+
+static BinaryRegistry registry;
+
+static void formatMessage(std::string& output, std::string_view format, const std::vector<BinaryValue>& arguments)
+{
+	size_t nextArgument = 0;
+
+	for (size_t i = 0; i < format.size(); i++)
+	{
+		char symbol = format[i];
+
+		if ((symbol == '{' || symbol == '}') && i + 1 < format.size() && format[i + 1] == symbol)
+		{
+			output += symbol;
+
+			i++;
+
+			continue;
+		}
+
+		if (symbol != '{')
+		{
+			output += symbol;
+
+			continue;
+		}
+
+		size_t end = format.find('}', i);
+
+		if (end == std::string_view::npos)
+		{
+			output += format.substr(i);
+
+			break;
+		}
+
+		std::string_view field = format.substr(i + 1, end - i - 1);
+		size_t colon = field.find(':');
+		std::string_view index = field.substr(0, colon);
+		size_t argumentIndex = nextArgument++;
+
+		if (index.size())
+		{
+			std::from_chars(index.data(), index.data() + index.size(), argumentIndex);
+		}
+
+		std::string fieldFormat = colon == std::string_view::npos ? "{}" : std::format("{{{}}}", field.substr(colon));
+
+		try
+		{
+			std::visit
+			(
+				[&output, &fieldFormat](const auto& value)
+				{
+					std::vformat_to(std::back_inserter(output), fieldFormat, std::make_format_args(value));
+				},
+				arguments.at(argumentIndex)
+			);
+		}
+		catch (const std::exception&)
+		{
+			// Missing argument or specification that doesn't match decoded type
+			output += format.substr(i, end - i + 1);
+		}
+
+		i = end;
+	}
+}
+
+size_t Log::BinaryLog::beginEntry(std::string& buffer, BinaryEntry type)
+{
+	size_t result = buffer.size();
+
+	buffer += static_cast<char>(type);
+
+	Log::appendBinary(buffer, uint32_t(0));
+
+	return result;
+}
+
+void Log::BinaryLog::endEntry(std::string& buffer, size_t position)
+{
+	uint32_t size = static_cast<uint32_t>(buffer.size() - position - entryHeaderSize);
+
+	std::memcpy(buffer.data() + position + sizeof(BinaryEntry), &size, sizeof(size));
+}
+
+void Log::BinaryLog::appendString(std::string& buffer, std::string_view text)
+{
+	Log::appendBinary(buffer, static_cast<uint32_t>(text.size()));
+
+	buffer += text;
+}
+
+bool Log::BinaryLog::define(std::vector<bool>& defined, uint32_t id)
+{
+	if (id >= defined.size())
+	{
+		defined.resize(id + 1);
+	}
+
+	if (defined[id])
+	{
+		return false;
+	}
+
+	defined[id] = true;
+
+	return true;
+}
+
+uint32_t Log::BinaryLog::internCallSite(std::string_view format)
+{
+	std::unique_lock<std::mutex> lock(registry.registryMutex);
+
+	auto [it, inserted] = registry.callSiteIds.try_emplace(std::string(format), static_cast<uint32_t>(registry.callSites.size()));
+
+	if (inserted)
+	{
+		registry.callSites.emplace_back(format);
+	}
+
+	return it->second;
+}
+
+uint32_t Log::BinaryLog::internThread(std::string_view threadId)
+{
+	std::unique_lock<std::mutex> lock(registry.registryMutex);
+
+	// Reused system ids and repeated thread names share index
+	auto [it, inserted] = registry.threadIds.try_emplace(std::string(threadId), static_cast<uint32_t>(registry.threads.size()));
+
+	if (inserted)
+	{
+		registry.threads.emplace_back(threadId);
+	}
+
+	return it->second;
+}
+
+std::chrono::system_clock::time_point Log::BinaryLog::getTimestamp(std::string_view record)
+{
+	int64_t timestamp;
+
+	std::memcpy(&timestamp, record.data() + timestampOffset, sizeof(timestamp));
+
+	return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp)));
+}
+
+void Log::BinaryLog::decode(std::istream& input, std::ostream& output)
+{
+	std::vector<LayoutSegment> layout;
+	DateFormat dateFormat = DateFormat::DMY;
+	std::string zoneName;
+	int64_t zoneOffset = 0;
+	std::unordered_map<uint32_t, std::string> callSites;
+	std::unordered_map<uint32_t, std::string> threads;
+	std::vector<BinaryValue> arguments;
+	std::string payload;
+	std::string line;
+	char type;
+
+	while (input.get(type))
+	{
+		uint32_t size;
+
+		if (!input.read(reinterpret_cast<char*>(&size), sizeof(size)))
+		{
+			throw std::runtime_error("Truncated binary log entry");
+		}
+
+		payload.resize(size);
+
+		if (!input.read(payload.data(), size))
+		{
+			throw std::runtime_error("Truncated binary log entry");
+		}
+
+		BinaryReader reader(payload);
+
+		switch (static_cast<BinaryEntry>(type))
+		{
+		case BinaryEntry::header:
+		{
+			dateFormat = static_cast<DateFormat>(reader.read<uint8_t>());
+			zoneName = reader.readString();
+
+			uint32_t count = reader.read<uint32_t>();
+
+			layout.clear();
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				LayoutOperation operation = static_cast<LayoutOperation>(reader.read<uint8_t>());
+
+				layout.push_back(LayoutSegment{ operation, std::string(reader.readString()) });
+			}
+
+			callSites.clear();
+			threads.clear();
+		}
+
+		break;
+
+		case BinaryEntry::callSite:
+		{
+			uint32_t id = reader.read<uint32_t>();
+
+			callSites[id] = reader.readString();
+		}
+
+		break;
+
+		case BinaryEntry::thread:
+		{
+			uint32_t index = reader.read<uint32_t>();
+
+			threads[index] = reader.readString();
+		}
+
+		break;
+
+		case BinaryEntry::zoneOffset:
+			zoneOffset = reader.read<int64_t>();
+
+			break;
+
+		case BinaryEntry::record:
+		{
+			uint32_t callSite = reader.read<uint32_t>();
+			uint32_t thread = reader.read<uint32_t>();
+			Level level = static_cast<Level>(reader.read<uint8_t>());
+			std::chrono::nanoseconds timestamp(reader.read<int64_t>());
+			std::string_view category = reader.readString();
+			uint8_t argumentsCount = reader.read<uint8_t>();
+
+			arguments.clear();
+
+			for (uint8_t i = 0; i < argumentsCount; i++)
+			{
+				switch (static_cast<BinaryArgument>(reader.read<uint8_t>()))
+				{
+				case BinaryArgument::boolean:
+					arguments.emplace_back(static_cast<bool>(reader.read<uint8_t>()));
+
+					break;
+
+				case BinaryArgument::character:
+					arguments.emplace_back(reader.read<char>());
+
+					break;
+
+				case BinaryArgument::signedInteger:
+					arguments.emplace_back(reader.read<int64_t>());
+
+					break;
+
+				case BinaryArgument::unsignedInteger:
+					arguments.emplace_back(reader.read<uint64_t>());
+
+					break;
+
+				case BinaryArgument::floatingPoint:
+					arguments.emplace_back(reader.read<double>());
+
+					break;
+
+				case BinaryArgument::string:
+					arguments.emplace_back(reader.readString());
+
+					break;
+
+				case BinaryArgument::pointer:
+					arguments.emplace_back(reinterpret_cast<const void*>(reader.read<uint64_t>()));
+
+					break;
+
+				case BinaryArgument::singleFloatingPoint:
+					arguments.emplace_back(reader.read<float>());
+
+					break;
+
+				case BinaryArgument::extendedFloatingPoint:
+					// Size of long double depends on platform, 8 bytes is same as double
+					if (uint8_t size = reader.read<uint8_t>(); size == sizeof(long double))
+					{
+						arguments.emplace_back(reader.read<long double>());
+					}
+					else if (size == sizeof(double))
+					{
+						arguments.emplace_back(reader.read<double>());
+					}
+					else
+					{
+						throw std::runtime_error("Unsupported long double size");
+					}
+
+					break;
+
+				default:
+					throw std::runtime_error("Wrong binary argument type");
+				}
+			}
+
+			std::chrono::seconds seconds = std::chrono::floor<std::chrono::seconds>(timestamp);
+
+			line.clear();
+
+			for (const LayoutSegment& segment : layout)
+			{
+				switch (segment.operation)
+				{
+				case LayoutOperation::text:
+					line += segment.text;
+
+					break;
+
+				case LayoutOperation::utcDate:
+					line += '[';
+
+					Log::appendFullDate(line, dateFormat, seconds);
+
+					line += " UTC]";
+
+					break;
+
+				case LayoutOperation::localDate:
+					line += '[';
+
+					Log::appendFullDate(line, dateFormat, seconds + std::chrono::seconds(zoneOffset));
+
+					line += ' ';
+					line += zoneName;
+					line += ']';
+
+					break;
+
+				case LayoutOperation::threadId:
+					line += threads[thread];
+
+					break;
+
+				case LayoutOperation::category:
+					line += category;
+
+					break;
+
+				case LayoutOperation::level:
+					line += Log::getLevelName(level);
+
+					break;
+
+				case LayoutOperation::message:
+					formatMessage(line, callSites[callSite], arguments);
+
+					break;
+
+				default:
+					// JSON layout is never written with binary log
+					break;
+				}
+			}
+
+			output << line << '\n';
+		}
+
+		break;
+
+		default:
+			// Unknown entries are skipped for compatibility with newer writers
+			break;
+		}
+	}
+}
+
+Log::BinaryLog::BinaryLog(const Log& log) :
+	log(log),
+	zoneOffset(0),
+	hasLocalDate(std::ranges::any_of(log.layout, [](const LayoutSegment& segment) { return segment.operation == LayoutOperation::localDate; }))
+{
+
+}
+
+size_t Log::BinaryLog::start(std::ostream& logFile)
+{
+	std::string header;
+	size_t position = BinaryLog::beginEntry(header, BinaryEntry::header);
+
+	header += static_cast<char>(log.logDateFormat);
+
+	BinaryLog::appendString(header, hasLocalDate ? Log::getLocalTimeZoneName() : std::string_view());
+
+	Log::appendBinary(header, static_cast<uint32_t>(log.layout.size()));
+
+	for (const LayoutSegment& segment : log.layout)
+	{
+		header += static_cast<char>(segment.operation);
+
+		BinaryLog::appendString(header, segment.text);
+	}
+
+	BinaryLog::endEntry(header, position);
+
+	definedCallSites.clear();
+	definedThreads.clear();
+
+	// Force zone offset entry before first record of file
+	zoneOffset = std::numeric_limits<int64_t>::min();
+
+	logFile.write(header.data(), header.size());
+
+	return header.size();
+}
+
+size_t Log::BinaryLog::write(std::ostream& logFile, std::string_view record)
+{
+	uint32_t callSite;
+	uint32_t thread;
+
+	std::memcpy(&callSite, record.data() + entryHeaderSize, sizeof(callSite));
+	std::memcpy(&thread, record.data() + entryHeaderSize + sizeof(callSite), sizeof(thread));
+
+	definitions.clear();
+
+	if (BinaryLog::define(definedCallSites, callSite))
+	{
+		size_t position = BinaryLog::beginEntry(definitions, BinaryEntry::callSite);
+
+		Log::appendBinary(definitions, callSite);
+
+		{
+			std::unique_lock<std::mutex> lock(registry.registryMutex);
+
+			BinaryLog::appendString(definitions, registry.callSites[callSite]);
+		}
+
+		BinaryLog::endEntry(definitions, position);
+	}
+
+	if (BinaryLog::define(definedThreads, thread))
+	{
+		size_t position = BinaryLog::beginEntry(definitions, BinaryEntry::thread);
+
+		Log::appendBinary(definitions, thread);
+
+		{
+			std::unique_lock<std::mutex> lock(registry.registryMutex);
+
+			BinaryLog::appendString(definitions, registry.threads[thread]);
+		}
+
+		BinaryLog::endEntry(definitions, position);
+	}
+
+	if (hasLocalDate)
+	{
+		int64_t offset = Log::getLocalTimeZoneOffset(std::chrono::floor<std::chrono::seconds>(BinaryLog::getTimestamp(record))).count();
+
+		if (offset != zoneOffset)
+		{
+			size_t position = BinaryLog::beginEntry(definitions, BinaryEntry::zoneOffset);
+
+			Log::appendBinary(definitions, offset);
+
+			BinaryLog::endEntry(definitions, position);
+
+			zoneOffset = offset;
+		}
+	}
+
+	if (definitions.size())
+	{
+		logFile.write(definitions.data(), definitions.size());
+	}
+
+	logFile.write(record.data(), record.size());
+
+	return definitions.size() + record.size();
+}
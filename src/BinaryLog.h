@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Log.h"
+
+/**
+ * @brief Writer side of .binlog files and decoder. Call sites and threads are defined once per file before first record that uses them
+ */
+class Log::BinaryLog
+{
+private:
+	static constexpr size_t entryHeaderSize = sizeof(BinaryEntry) + sizeof(uint32_t);
+	static constexpr size_t timestampOffset = entryHeaderSize + sizeof(uint32_t) * 2 + sizeof(uint8_t);
+
+private:
+	const Log& log;
+	std::vector<bool> definedCallSites;
+	std::vector<bool> definedThreads;
+	std::string definitions;
+	int64_t zoneOffset;
+	bool hasLocalDate;
+
+private:
+	static size_t beginEntry(std::string& buffer, BinaryEntry type);
+
+	static void endEntry(std::string& buffer, size_t position);
+
+	static void appendString(std::string& buffer, std::string_view text);
+
+	static bool define(std::vector<bool>& defined, uint32_t id);
+
+public:
+	/**
+	 * @brief Get existing or new id of format. Thread safe
+	 */
+	static uint32_t internCallSite(std::string_view format);
+
+	/**
+	 * @brief Get existing or new index for rendered thread id. Thread safe
+	 */
+	static uint32_t internThread(std::string_view threadId);
+
+	/**
+	 * @brief Get time when record was made
+	 */
+	static std::chrono::system_clock::time_point getTimestamp(std::string_view record);
+
+	/**
+	 * @brief Convert .binlog file into text records
+	 */
+	static void decode(std::istream& input, std::ostream& output);
+
+public:
+	/**
+	 * @param log Owner of layout and log file
+	 */
+	BinaryLog(const Log& log);
+
+	/**
+	 * @brief Write header into newly opened log file and forget definitions
+	 * @return Number of written bytes
+	 */
+	size_t start(std::ostream& logFile);
+
+	/**
+	 * @brief Write definitions needed by record and record itself
+	 * @return Number of written bytes
+	 */
+	size_t write(std::ostream& logFile, std::string_view record);
+
+	~BinaryLog() = default;
+};
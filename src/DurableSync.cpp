@@ -0,0 +1,236 @@
+#include "DurableSync.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+
+#ifdef __LINUX__
+#include <unistd.h>
+#elif defined(__ANDROID__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+void Log::DurableSync::syncDescriptor(int descriptor)
+{
+	if (descriptor == -1)
+	{
+		return;
+	}
+
+#if defined(__LINUX__) || defined(__ANDROID__)
+	fdatasync(descriptor);
+#else
+	_commit(descriptor);
+#endif
+}
+
+void Log::DurableSync::closeDescriptor(int descriptor)
+{
+	if (descriptor == -1)
+	{
+		return;
+	}
+
+#if defined(__LINUX__) || defined(__ANDROID__)
+	::close(descriptor);
+#else
+	_close(descriptor);
+#endif
+}
+
+void Log::DurableSync::run()
+{
+	std::unique_lock<std::mutex> lock(descriptorMutex);
+
+	while (true)
+	{
+		descriptorCondition.wait(lock, [this]() { return retiredDescriptors.size() || !running; });
+
+		if (retiredDescriptors.empty())
+		{
+			break;
+		}
+
+		std::vector<int> retired = std::move(retiredDescriptors);
+
+		retiredDescriptors.clear();
+
+		retiring = true;
+
+		lock.unlock();
+
+		for (int retiredDescriptor : retired)
+		{
+			DurableSync::syncDescriptor(retiredDescriptor);
+			DurableSync::closeDescriptor(retiredDescriptor);
+		}
+
+		lock.lock();
+
+		retiring = false;
+
+		descriptorCondition.notify_all();
+	}
+}
+
+uint64_t Log::DurableSync::syncLogFile()
+{
+	uint64_t result;
+	std::vector<int> descriptors;
+
+	{
+		std::unique_lock<std::mutex> descriptorLock;
+
+		{
+			std::unique_lock<std::mutex> writeLock(log.writeMutex);
+
+			log.flushLogFile();
+
+			result = log.writtenRecords.load(std::memory_order_relaxed);
+
+			descriptorLock = std::unique_lock<std::mutex>(descriptorMutex);
+		}
+
+		// Records of rotated log files must be on stable storage too, including descriptors retired during wait
+		descriptorCondition.wait(descriptorLock, [this]() { return !retiring; });
+
+		descriptors = std::move(retiredDescriptors);
+
+		retiredDescriptors.clear();
+
+		// Rotation takes descriptorMutex under writeMutex, sync duplicate so rotation doesn't wait for it
+		if (descriptor != -1)
+		{
+#if defined(__LINUX__) || defined(__ANDROID__)
+			descriptors.push_back(::dup(descriptor));
+#else
+			descriptors.push_back(_dup(descriptor));
+#endif
+		}
+	}
+
+	for (int syncedDescriptor : descriptors)
+	{
+		DurableSync::syncDescriptor(syncedDescriptor);
+		DurableSync::closeDescriptor(syncedDescriptor);
+	}
+
+	return result;
+}
+
+Log::DurableSync::DurableSync(Log& log, std::chrono::microseconds maxWait) :
+	log(log),
+	maxWait(maxWait),
+	descriptor(-1),
+	retiring(false),
+	running(true),
+	syncedRecords(0),
+	waitingCallers(0),
+	lastSyncCallers(0),
+	syncing(false),
+	statistics()
+{
+	retireThread = std::thread(&DurableSync::run, this);
+}
+
+void Log::DurableSync::open(const std::filesystem::path& logFilePath)
+{
+	{
+		std::unique_lock<std::mutex> lock(descriptorMutex);
+
+		if (descriptor != -1)
+		{
+			retiredDescriptors.push_back(descriptor);
+		}
+
+#if defined(__LINUX__) || defined(__ANDROID__)
+		descriptor = ::open(logFilePath.c_str(), O_WRONLY | O_CLOEXEC);
+#else
+		descriptor = _wopen(logFilePath.c_str(), _O_WRONLY);
+#endif
+	}
+
+	descriptorCondition.notify_all();
+}
+
+void Log::DurableSync::waitDurable(uint64_t writtenRecords)
+{
+	std::unique_lock<std::mutex> lock(syncMutex);
+
+	waitingCallers++;
+
+	while (syncedRecords < writtenRecords)
+	{
+		if (syncing)
+		{
+			// Leader may be waiting for this record
+			leaderCondition.notify_one();
+
+			syncCondition.wait(lock);
+
+			continue;
+		}
+
+		syncing = true;
+
+		// Without other pending callers there is no one to wait for
+		if (maxWait.count() && waitingCallers > 1)
+		{
+			// Let concurrent callers write their records so one sync covers them all
+			leaderCondition.wait_for(lock, maxWait, [this]() { return waitingCallers >= lastSyncCallers; });
+		}
+
+		// Callers in waitDurable wrote their records before it
+		size_t syncCallers = waitingCallers;
+
+		lock.unlock();
+
+		uint64_t synced = this->syncLogFile();
+
+		lock.lock();
+
+		if (synced > syncedRecords)
+		{
+			uint64_t covered = synced - syncedRecords;
+
+			statistics.syncs++;
+			statistics.records += covered;
+			statistics.lastSyncRecords = covered;
+			statistics.maxSyncRecords = std::max(statistics.maxSyncRecords, covered);
+
+			syncedRecords = synced;
+		}
+
+		lastSyncCallers = syncCallers;
+		syncing = false;
+
+		syncCondition.notify_all();
+	}
+
+	waitingCallers--;
+}
+
+Log::DurabilityStatistics Log::DurableSync::getStatistics()
+{
+	std::unique_lock<std::mutex> lock(syncMutex);
+
+	return statistics;
+}
+
+Log::DurableSync::~DurableSync()
+{
+	{
+		std::unique_lock<std::mutex> lock(descriptorMutex);
+
+		running = false;
+	}
+
+	descriptorCondition.notify_all();
+
+	retireThread.join();
+
+	DurableSync::syncDescriptor(descriptor);
+	DurableSync::closeDescriptor(descriptor);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+
+/**
+ * @brief Group commit of log file data to stable storage. Concurrent callers share one sync. Descriptors of rotated log files are synced and closed on background thread
+ */
+class Log::DurableSync
+{
+private:
+	Log& log;
+	std::chrono::microseconds maxWait;
+	std::mutex syncMutex;
+	std::condition_variable syncCondition;
+	std::condition_variable leaderCondition;
+	std::mutex descriptorMutex;
+	std::condition_variable descriptorCondition;
+	int descriptor;
+	std::vector<int> retiredDescriptors;
+	bool retiring;
+	bool running;
+	uint64_t syncedRecords;
+	size_t waitingCallers;
+	size_t lastSyncCallers;
+	bool syncing;
+	DurabilityStatistics statistics;
+	std::thread retireThread;
+
+private:
+	static void syncDescriptor(int descriptor);
+
+	static void closeDescriptor(int descriptor);
+
+	void run();
+
+	uint64_t syncLogFile();
+
+public:
+	/**
+	 * @param log Owner of log file
+	 * @param maxWait How long sync leader waits for other callers before sync. Only waits when other callers are pending, ends early when as many callers are pending as last sync covered. 0 for no waiting
+	 */
+	DurableSync(Log& log, std::chrono::microseconds maxWait);
+
+	/**
+	 * @brief Open descriptor for new log file, previous descriptor is synced on background thread. Called under writeMutex after logFile is flushed
+	 */
+	void open(const std::filesystem::path& logFilePath);
+
+	/**
+	 * @brief Wait until first writtenRecords records are on stable storage
+	 */
+	void waitDurable(uint64_t writtenRecords);
+
+	DurabilityStatistics getStatistics();
+
+	~DurableSync();
+};
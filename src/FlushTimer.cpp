@@ -0,0 +1,37 @@
+#include "FlushTimer.h"
+
+void Log::FlushTimer::run()
+{
+	std::unique_lock<std::mutex> lock(timerMutex);
+
+	while (running)
+	{
+		lock.unlock();
+
+		std::chrono::steady_clock::time_point deadline = log.flushExpired();
+
+		lock.lock();
+
+		timerCondition.wait_until(lock, deadline, [this]() { return !running; });
+	}
+}
+
+Log::FlushTimer::FlushTimer(Log& log) :
+	log(log),
+	running(true)
+{
+	timerThread = std::thread(&FlushTimer::run, this);
+}
+
+Log::FlushTimer::~FlushTimer()
+{
+	{
+		std::unique_lock<std::mutex> lock(timerMutex);
+
+		running = false;
+	}
+
+	timerCondition.notify_all();
+
+	timerThread.join();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+
+/**
+ * @brief Background thread that flushes log file when FlushPolicy::interval passed since last flush, even if nothing else is logged
+ */
+class Log::FlushTimer
+{
+private:
+	Log& log;
+	std::mutex timerMutex;
+	std::condition_variable timerCondition;
+	bool running;
+	std::thread timerThread;
+
+private:
+	void run();
+
+public:
+	FlushTimer(Log& log);
+
+	~FlushTimer();
+};
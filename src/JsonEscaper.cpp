@@ -0,0 +1,270 @@
+#include "JsonEscaper.h"
+
+#include <bit>
+
+#ifdef LOG_JSON_SIMD
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+
+#define LOG_TARGET_AVX2
+#else
+#define LOG_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static bool isEscaped(char value)
+{
+	return static_cast<unsigned char>(value) < 0x20 || value == '"' || value == '\\';
+}
+
+size_t Log::JsonEscaper::findScalar(std::string_view text)
+{
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (isEscaped(text[i]))
+		{
+			return i;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+#ifdef LOG_JSON_SIMD
+size_t Log::JsonEscaper::findSse2(std::string_view text)
+{
+	constexpr size_t width = sizeof(__m128i);
+
+	if (text.size() < width)
+	{
+		return JsonEscaper::findScalar(text);
+	}
+
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i lastControl = _mm_set1_epi8(0x1F);
+	size_t offset = 0;
+
+	while (true)
+	{
+		// Last chunk overlaps clean bytes that were already scanned
+		if (offset + width > text.size())
+		{
+			if (offset == text.size())
+			{
+				break;
+			}
+
+			offset = text.size() - width;
+		}
+
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+		// Unsigned chunk <= 0x1F, bytes above 0x7F are UTF-8 and stay as they are
+		__m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl);
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), control)));
+
+		if (mask)
+		{
+			return offset + std::countr_zero(mask);
+		}
+
+		if (offset + width == text.size())
+		{
+			break;
+		}
+
+		offset += width;
+	}
+
+	return std::string_view::npos;
+}
+
+LOG_TARGET_AVX2 size_t Log::JsonEscaper::findAvx2(std::string_view text)
+{
+	constexpr size_t width = sizeof(__m256i);
+
+	if (text.size() < width)
+	{
+		return JsonEscaper::findSse2(text);
+	}
+
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i lastControl = _mm256_set1_epi8(0x1F);
+	size_t offset = 0;
+
+	while (true)
+	{
+		if (offset + width > text.size())
+		{
+			if (offset == text.size())
+			{
+				break;
+			}
+
+			offset = text.size() - width;
+		}
+
+		__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + offset));
+		__m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, lastControl), lastControl);
+		uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), control)));
+
+		if (mask)
+		{
+			return offset + std::countr_zero(mask);
+		}
+
+		if (offset + width == text.size())
+		{
+			break;
+		}
+
+		offset += width;
+	}
+
+	return std::string_view::npos;
+}
+
+bool Log::JsonEscaper::hasAvx2()
+{
+#ifdef _MSC_VER
+	int registers[4];
+
+	__cpuid(registers, 0);
+
+	if (registers[0] < 7)
+	{
+		return false;
+	}
+
+	__cpuid(registers, 1);
+
+	// Operating system must save AVX registers
+	if (!(registers[2] & (1 << 27)) || !(registers[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(registers, 7, 0);
+
+	return registers[1] & (1 << 5);
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+void Log::JsonEscaper::appendEscaped(std::string& buffer, char value)
+{
+	static constexpr std::string_view hexDigits = "0123456789abcdef";
+
+	buffer += '\\';
+
+	switch (value)
+	{
+	case '"':
+		buffer += '"';
+
+		break;
+
+	case '\\':
+		buffer += '\\';
+
+		break;
+
+	case '\b':
+		buffer += 'b';
+
+		break;
+
+	case '\f':
+		buffer += 'f';
+
+		break;
+
+	case '\n':
+		buffer += 'n';
+
+		break;
+
+	case '\r':
+		buffer += 'r';
+
+		break;
+
+	case '\t':
+		buffer += 't';
+
+		break;
+
+	default:
+		buffer += "u00";
+		buffer += hexDigits[static_cast<unsigned char>(value) >> 4];
+		buffer += hexDigits[static_cast<unsigned char>(value) & 0xF];
+
+		break;
+	}
+}
+
+size_t Log::JsonEscaper::find(std::string_view text)
+{
+#ifdef LOG_JSON_SIMD
+	static const auto implementation = JsonEscaper::hasAvx2() ? &JsonEscaper::findAvx2 : &JsonEscaper::findSse2;
+
+	return implementation(text);
+#else
+	return JsonEscaper::findScalar(text);
+#endif
+}
+
+void Log::JsonEscaper::append(std::string& buffer, std::string_view text)
+{
+	buffer += '"';
+
+	for (size_t position = JsonEscaper::find(text); position != std::string_view::npos; position = JsonEscaper::find(text))
+	{
+		buffer.append(text.data(), position);
+
+		JsonEscaper::appendEscaped(buffer, text[position]);
+
+		text.remove_prefix(position + 1);
+	}
+
+	buffer += text;
+	buffer += '"';
+}
+
+void Log::JsonEscaper::escape(std::string& buffer, size_t start)
+{
+	thread_local std::string tail;
+
+	size_t position = JsonEscaper::find(std::string_view(buffer).substr(start));
+
+	if (position == std::string_view::npos)
+	{
+		return;
+	}
+
+	tail.assign(buffer, start + position);
+
+	buffer.resize(start + position);
+
+	std::string_view text(tail);
+
+	position = 0;
+
+	do
+	{
+		buffer.append(text.data(), position);
+
+		JsonEscaper::appendEscaped(buffer, text[position]);
+
+		text.remove_prefix(position + 1);
+
+		position = JsonEscaper::find(text);
+	} while (position != std::string_view::npos);
+
+	buffer += text;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Log.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LOG_JSON_SIMD
+#endif
+
+/**
+ * @brief Escapes strings for JSON records. SIMD scan finds characters that must be escaped, clean runs are copied in bulk
+ */
+class Log::JsonEscaper
+{
+private:
+	static size_t findScalar(std::string_view text);
+
+#ifdef LOG_JSON_SIMD
+	static size_t findSse2(std::string_view text);
+
+	static size_t findAvx2(std::string_view text);
+
+	static bool hasAvx2();
+#endif
+
+	static void appendEscaped(std::string& buffer, char value);
+
+public:
+	/**
+	 * @brief Position of first quotation mark, backslash or control character. AVX2 if processor supports it, otherwise SSE2 on x86-64 and scalar on other platforms
+	 * @return std::string_view::npos if text doesn't need escaping
+	 */
+	static size_t find(std::string_view text);
+
+	/**
+	 * @brief Append text as JSON string with quotation marks
+	 */
+	static void append(std::string& buffer, std::string_view text);
+
+	/**
+	 * @brief Escape buffer from start in place. Clean text is not copied
+	 */
+	static void escape(std::string& buffer, size_t start);
+};
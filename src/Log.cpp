@@ -4,9 +4,29 @@
 #include <vector>
 #include <thread>
 #include <format>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <deque>
+
+#include "RecordQueue.h"
+#include "SegmentPreparer.h"
+#include "DurableSync.h"
+#include "BatchedFileWriter.h"
+#include "MappedSegmentWriter.h"
+#include "UringFileWriter.h"
+#include "BinaryLog.h"
+#include "SegmentCompressor.h"
+#include "RetentionEnforcer.h"
+#include "SinkDispatcher.h"
+#include "SuppressionReporter.h"
+#include "FlushTimer.h"
+#include "JsonEscaper.h"
+#include "SharedWriter.h"
 
 #ifdef __LINUX__
 #include <sys/types.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 #elif defined(__ANDROID__)
 #include <ctime>
@@ -14,160 +34,1113 @@
 #include <Windows.h>
 #endif
 
-static constexpr uint16_t dateSize = 10;
 static constexpr uint16_t fullDateSize = 17;
+static constexpr size_t dateFormatsCount = 3;
+static constexpr size_t isoMillisecondsOffset = 21; /// Milliseconds after quotation mark and YYYY-MM-DDThh:mm:ss.
 
+/**
+ * @brief Per thread formatted date, rebuilt when second changes
+ */
+struct CachedDate
+{
+	int64_t second = std::numeric_limits<int64_t>::min();
+	std::string text;
+};
+
+/**
+ * @brief Per thread rendered thread id fields
+ */
+struct ThreadIdCache
+{
+	std::string standard;
+	std::string system;
+	std::string name;
+	std::string jsonStandard;
+	std::string jsonSystem;
+	std::string jsonName;
+	std::array<uint32_t, 2> binaryThreads = { std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max() }; /// For each ThreadIdFormat
+};
+
+/**
+ * @brief Small ids of categories of CategorySite and categories that had verbosity level in any logger, shared by all threads. Text categories without levels are never added
+ */
+class CategoryRegistry
+{
+public:
+	static inline constexpr uint32_t noId = std::numeric_limits<uint32_t>::max();
+
+private:
+	std::mutex registryMutex;
+	std::unordered_map<std::string_view, uint32_t> ids;
+	std::deque<std::string> names;
+	std::atomic<uint32_t> generation = 0;
+
+public:
+	/**
+	 * @brief Changes when category is added, cached noId is stale after that
+	 */
+	uint32_t getGeneration() const
+	{
+		return generation.load(std::memory_order_acquire);
+	}
+
+	uint32_t find(std::string_view category)
+	{
+		std::unique_lock<std::mutex> lock(registryMutex);
+
+		auto it = ids.find(category);
+
+		return it != ids.end() ? it->second : noId;
+	}
+
+	/**
+	 * @return noId if capacity categories already have ids
+	 */
+	uint32_t intern(std::string_view category, size_t capacity)
+	{
+		std::unique_lock<std::mutex> lock(registryMutex);
+
+		if (auto it = ids.find(category); it != ids.end())
+		{
+			return it->second;
+		}
+
+		if (names.size() >= capacity)
+		{
+			return noId;
+		}
+
+		// Deque keeps names in place, map keys point into them
+		std::string_view name = names.emplace_back(category);
+		uint32_t id = static_cast<uint32_t>(names.size() - 1);
+
+		ids.emplace(name, id);
+		generation.fetch_add(1, std::memory_order_release);
+
+		return id;
+	}
+};
+
+static CategoryRegistry& getCategoryRegistry()
+{
+	// Static CategorySite of other translation unit may be constructed before globals of this one
+	static CategoryRegistry registry;
+
+	return registry;
+}
+
+/**
+ * @brief Log folders of all loggers, each logger owns its folder
+ */
+class BasePathRegistry
+{
+private:
+	std::mutex registryMutex;
+	std::vector<std::pair<std::filesystem::path, const Log*>> basePaths;
+
+public:
+	bool add(const std::filesystem::path& basePath, const Log& log)
+	{
+		std::unique_lock<std::mutex> lock(registryMutex);
+
+		if (std::ranges::any_of(basePaths, [&basePath](const auto& entry) { return entry.first == basePath; }))
+		{
+			return false;
+		}
+
+		basePaths.emplace_back(basePath, &log);
+
+		return true;
+	}
+
+	void remove(const Log& log)
+	{
+		std::unique_lock<std::mutex> lock(registryMutex);
+
+		std::erase_if(basePaths, [&log](const auto& entry) { return entry.second == &log; });
+	}
+};
+
+static BasePathRegistry basePathRegistry;
+static thread_local bool recordBufferUsed = false;
 static std::unique_ptr<Log> instance;
+static thread_local ThreadIdCache threadIdCache;
+
+#ifndef __ANDROID__
+/**
+ * @brief Local time zone resolved once, UTC offset cached until next transition
+ */
+class LocalTimeZone
+{
+private:
+	const std::chrono::time_zone* zone;
+	std::mutex resolveMutex;
+	std::atomic<int64_t> offset;
+	std::atomic<int64_t> transition;
+
+private:
+	void update(std::chrono::sys_seconds now)
+	{
+		if (!zone)
+		{
+			zone = std::chrono::get_tzdb().current_zone();
+		}
+
+		std::chrono::sys_info info = zone->get_info(now);
+
+		offset.store(info.offset.count(), std::memory_order_relaxed);
+		transition.store(info.end.time_since_epoch().count(), std::memory_order_release);
+	}
+
+public:
+	LocalTimeZone() :
+		zone(nullptr),
+		offset(0),
+		transition(std::numeric_limits<int64_t>::min())
+	{
+
+	}
+
+	void resolve()
+	{
+		std::unique_lock<std::mutex> lock(resolveMutex);
+
+		this->update(std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+	}
+
+	std::chrono::seconds getOffset(std::chrono::sys_seconds now)
+	{
+		if (now.time_since_epoch().count() >= transition.load(std::memory_order_acquire))
+		{
+			std::unique_lock<std::mutex> lock(resolveMutex);
+
+			if (now.time_since_epoch().count() >= transition.load(std::memory_order_relaxed))
+			{
+				this->update(now);
+			}
+		}
+
+		return std::chrono::seconds(offset.load(std::memory_order_relaxed));
+	}
+
+	std::string_view getName()
+	{
+		if (transition.load(std::memory_order_acquire) == std::numeric_limits<int64_t>::min())
+		{
+			this->resolve();
+		}
+
+		return zone->name();
+	}
+};
+
+static LocalTimeZone localTimeZone;
+#endif
+
+template<typename OutputIteratorT>
+static OutputIteratorT formatDate(OutputIteratorT output, Log::DateFormat logDateFormat, std::chrono::year_month_day date)
+{
+	unsigned int day = static_cast<unsigned int>(date.day());
+	unsigned int month = static_cast<unsigned int>(date.month());
+	int year = static_cast<int>(date.year());
+
+	switch (logDateFormat)
+	{
+	case Log::DateFormat::DMY:
+		return std::format_to(output, "{:02}.{:02}.{:04}", day, month, year);
+
+	case Log::DateFormat::MDY:
+		return std::format_to(output, "{:02}.{:02}.{:04}", month, day, year);
+
+	case Log::DateFormat::YMD:
+		return std::format_to(output, "{:04}.{:02}.{:02}", year, month, day);
+
+	default:
+		throw std::runtime_error(std::format("Wrong DateFormat in {}", __FUNCTION__));
+	}
+
+	return output;
+}
+
+template<typename OutputIteratorT>
+static OutputIteratorT formatFullDate(OutputIteratorT output, Log::DateFormat logDateFormat, std::chrono::seconds sinceEpoch)
+{
+	std::chrono::days days = std::chrono::floor<std::chrono::days>(sinceEpoch);
+	std::chrono::hh_mm_ss<std::chrono::seconds> time(sinceEpoch - days);
+
+	output = formatDate(output, logDateFormat, std::chrono::year_month_day(std::chrono::sys_days(days)));
+
+	return std::format_to(output, "-{:02}.{:02}.{:02}", time.hours().count(), time.minutes().count(), time.seconds().count());
+}
+
+/**
+ * @brief JSON string with ISO 8601 time, milliseconds are zeros. UTC without offset
+ */
+template<typename OutputIteratorT>
+static OutputIteratorT formatIsoDate(OutputIteratorT output, std::chrono::seconds sinceEpoch, std::optional<std::chrono::seconds> offset)
+{
+	std::chrono::seconds time = sinceEpoch + offset.value_or(std::chrono::seconds(0));
+	std::chrono::days days = std::chrono::floor<std::chrono::days>(time);
+	std::chrono::year_month_day date = std::chrono::sys_days(days);
+	std::chrono::hh_mm_ss<std::chrono::seconds> timeOfDay(time - days);
+
+	output = std::format_to
+	(
+		output,
+		"\"{:04}-{:02}-{:02}T{:02}:{:02}:{:02}.000",
+		static_cast<int>(date.year()),
+		static_cast<unsigned int>(date.month()),
+		static_cast<unsigned int>(date.day()),
+		timeOfDay.hours().count(),
+		timeOfDay.minutes().count(),
+		timeOfDay.seconds().count()
+	);
+
+	if (!offset)
+	{
+		return std::format_to(output, "Z\"");
+	}
+
+	int64_t minutes = std::chrono::duration_cast<std::chrono::minutes>(*offset).count();
+
+	return std::format_to(output, "{}{:02}:{:02}\"", minutes < 0 ? '-' : '+', std::abs(minutes) / 60, std::abs(minutes) % 60);
+}
+
+/**
+ * @brief Append cached ISO 8601 date and write milliseconds into it
+ */
+static void appendIsoDate(std::string& buffer, const std::string& date, int64_t milliseconds)
+{
+	size_t position = buffer.size() + isoMillisecondsOffset;
+
+	buffer += date;
+
+	buffer[position] = static_cast<char>('0' + milliseconds / 100);
+	buffer[position + 1] = static_cast<char>('0' + milliseconds / 10 % 10);
+	buffer[position + 2] = static_cast<char>('0' + milliseconds % 10);
+}
+
+Log::DateFormat Log::dateFormatFromString(const std::string& source)
+{
+	if (source == "DMY")
+	{
+		return DateFormat::DMY;
+	}
+	else if (source == "MDY")
+	{
+		return DateFormat::MDY;
+	}
+	else if (source == "YMD")
+	{
+		return DateFormat::YMD;
+	}
+
+	throw std::invalid_argument("Can't convert source to DateFormat");
+}
+
+std::string_view Log::getLocalTimeZoneName()
+{
+#ifdef __ANDROID__
+	return tzname[0];
+#else
+	return localTimeZone.getName();
+#endif
+}
+
+std::string_view Log::getLevelName(Level level)
+{
+	switch (level)
+	{
+	case Level::info:
+		return "INFO";
+
+	case Level::warning:
+		return "WARNING";
+
+	case Level::error:
+		return "ERROR";
+
+	case Level::fatalError:
+		return "FATAL_ERROR";
+
+	default:
+		throw std::runtime_error("Wrong level type");
+	}
+
+	return {};
+}
+
+void Log::appendJsonString(std::string& buffer, std::string_view text)
+{
+	JsonEscaper::append(buffer, text);
+}
+
+void Log::escapeJsonString(std::string& buffer, size_t start)
+{
+	JsonEscaper::escape(buffer, start);
+}
+
+std::string Log::layoutFromFlags(uint64_t flags)
+{
+	std::string result;
+
+	if (flags & AdditionalInformation::utcDate)
+	{
+		result += "%utc";
+	}
+
+	if (flags & AdditionalInformation::localDate)
+	{
+		result += "%local";
+	}
+
+	if (flags & AdditionalInformation::processName)
+	{
+		result += "%pname";
+	}
+
+	if (flags & AdditionalInformation::processId)
+	{
+		result += "%pid";
+	}
+
+	if (flags & AdditionalInformation::threadId)
+	{
+		result += "%tid";
+	}
+
+	result += " %cat: %lvl: %msg";
+
+	return result;
+}
+
+bool Log::checkLevel(Level level, VerbosityLevel threshold)
+{
+	switch (threshold)
+	{
+	case VerbosityLevel::verbose:
+		return true;
+
+	case VerbosityLevel::warning:
+		return level >= Level::warning;
+
+	case VerbosityLevel::error:
+		return level >= Level::error;
+
+	default:
+		throw std::runtime_error(std::format("Wrong verbosityLevel in {}", __FUNCTION__));
+	}
+
+	return false;
+}
+
+void Log::appendFullDate(std::string& buffer, DateFormat logDateFormat, std::chrono::seconds sinceEpoch)
+{
+	formatFullDate(std::back_inserter(buffer), logDateFormat, sinceEpoch);
+}
+
+std::chrono::seconds Log::getLocalTimeZoneOffset(std::chrono::sys_seconds now)
+{
+#ifdef __ANDROID__
+	time_t currentTime = std::chrono::system_clock::to_time_t(now);
+	tm localTime;
+
+	localtime_r(&currentTime, &localTime);
+
+	return std::chrono::seconds(localTime.tm_gmtoff);
+#else
+	return localTimeZone.getOffset(now);
+#endif
+}
+
+uint32_t Log::getCallSite(std::string_view format, bool staticFormat)
+{
+	struct CachedCallSite
+	{
+		const char* data = nullptr;
+		size_t size = 0;
+		uint32_t id = 0;
+	};
+
+	if (!staticFormat)
+	{
+		return BinaryLog::internCallSite(format);
+	}
+
+	// Compile time format strings live in static storage, their address identifies call site
+	thread_local std::array<CachedCallSite, 64> cache;
+	CachedCallSite& cached = cache[(reinterpret_cast<uintptr_t>(format.data()) >> 3) % cache.size()];
+
+	if (cached.data != format.data() || cached.size != format.size())
+	{
+		cached = CachedCallSite{ format.data(), format.size(), BinaryLog::internCallSite(format) };
+	}
+
+	return cached.id;
+}
+
+uint32_t Log::getBinaryThread(const Log& log)
+{
+	uint32_t& binaryThread = threadIdCache.binaryThreads[static_cast<size_t>(log.threadIdFormat)];
+
+	if (binaryThread == std::numeric_limits<uint32_t>::max())
+	{
+		std::string threadId;
+
+		log.appendThreadId(threadId);
+
+		binaryThread = BinaryLog::internThread(threadId);
+	}
+
+	return binaryThread;
+}
+
+uint32_t Log::getCategoryId(std::string_view category)
+{
+	struct CachedCategory
+	{
+		const char* data = nullptr;
+		std::string name;
+		uint32_t id = CategoryRegistry::noId;
+		uint32_t generation = 0;
+	};
+
+	// Text categories are usually literals, their address identifies call site. CategorySite avoids this cache
+	thread_local std::array<CachedCategory, 64> cache;
+	CachedCategory& cached = cache[(reinterpret_cast<uintptr_t>(category.data()) >> 3) % cache.size()];
+
+	// Runtime category may reuse address with other text, comparing short name is still cheaper than hashing it
+	if (cached.data != category.data() || cached.name != category)
+	{
+		cached.data = category.data();
+		cached.name = category;
+		cached.generation = getCategoryRegistry().getGeneration();
+		cached.id = getCategoryRegistry().find(category);
+	}
+	else if (cached.id == CategoryRegistry::noId && cached.generation != getCategoryRegistry().getGeneration())
+	{
+		// Category may have got level since it was cached
+		cached.generation = getCategoryRegistry().getGeneration();
+		cached.id = getCategoryRegistry().find(category);
+	}
+
+	return cached.id;
+}
+
+bool Log::categoryFilter(Level level, Category category) const
+{
+	uint32_t id = category.site ? category.site->id : Log::getCategoryId(category.name);
+	int threshold = static_cast<int>(verbosityLevel.load(std::memory_order_relaxed));
+
+	if (id < categoryLevels.size())
+	{
+		if (uint8_t categoryLevel = categoryLevels[id].load(std::memory_order_relaxed))
+		{
+			threshold = categoryLevel - 1;
+		}
+	}
+
+	return static_cast<int>(level) >= threshold;
+}
+
+void Log::setCategoryLevel(std::string_view category, uint8_t level)
+{
+	// Reset doesn't need id, category without id has no level
+	uint32_t id = level ? getCategoryRegistry().intern(category, categoryLevels.size()) : getCategoryRegistry().find(category);
+
+	if (id == CategoryRegistry::noId)
+	{
+		if (!level)
+		{
+			return;
+		}
+
+		throw std::runtime_error(std::format("Can't set verbosity level of {}, only {} different categories can have levels", category, Log::maxCategoryLevels));
+	}
+
+	std::unique_lock<std::mutex> lock(categoryMutex);
+
+	categoryLevels[id].store(level, std::memory_order_relaxed);
+
+	this->updateLowestVerbosityLevel();
+}
+
+bool Log::admit(RateLimitSite& site, uint32_t count, std::chrono::nanoseconds period, Level type, std::string_view category)
+{
+	uint64_t window = RateLimitSite::getWindow(period);
+	// Admitted and suppressed records of current period cost one atomic operation
+	uint64_t state = site.state.fetch_add(1, std::memory_order_relaxed);
+
+	while ((state & ~RateLimitSite::recordsMask) != window)
+	{
+		// Other thread may have read clock later and started next period
+		window = RateLimitSite::getWindow(period);
+
+		if ((state & ~RateLimitSite::recordsMask) == window)
+		{
+			break;
+		}
+
+		// First record of period starts it and reports previous one, records that raced it are counted there too
+		if (site.state.compare_exchange_weak(state, window | 1, std::memory_order_relaxed))
+		{
+			if (uint64_t records = state & RateLimitSite::recordsMask; records > count)
+			{
+				this->writeSuppressedSummary(type, category, records - count);
+			}
+
+			state = window;
+
+			break;
+		}
+
+		if ((state & ~RateLimitSite::recordsMask) == window)
+		{
+			state = site.state.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	uint64_t records = state & RateLimitSite::recordsMask;
+
+	if (records < count)
+	{
+		return true;
+	}
+
+	// Only first suppressed record of period registers call site
+	if (records == count)
+	{
+		suppressionReporter->add(site, type, category, count, period);
+	}
+
+	return false;
+}
+
+void Log::writeSuppressedSummary(Level type, std::string_view category, uint64_t suppressed)
+{
+	this->log(type, "Suppressed {} similar messages", category, suppressed);
+}
+
+void Log::setLevel(VerbosityLevel level)
+{
+	std::unique_lock<std::mutex> lock(categoryMutex);
+
+	verbosityLevel = level;
+
+	this->updateLowestVerbosityLevel();
+}
+
+void Log::attachSink(const std::shared_ptr<Sink>& sink)
+{
+	std::unique_lock<std::mutex> lock(writeMutex);
+
+	sinkDispatcher->add(sink);
+}
+
+bool Log::detachSink(const std::shared_ptr<Sink>& sink)
+{
+	std::unique_lock<std::mutex> lock(writeMutex);
+
+	return sinkDispatcher->remove(sink);
+}
+
+void Log::flushRecords()
+{
+	if (queue)
+	{
+		queue->waitUntilConsumed();
+	}
+
+	SinkDispatcher::PushedRecords pushedRecords;
+
+	{
+		std::unique_lock<std::mutex> lock(writeMutex);
+
+		this->flushStreams();
+
+		pushedRecords = sinkDispatcher->getPushedRecords();
+	}
+
+	// Slow sinks don't block writers
+	SinkDispatcher::flush(pushedRecords);
+}
+
+std::filesystem::path Log::getLogFilePath()
+{
+	std::unique_lock<std::mutex> lock(writeMutex);
+
+	return currentLogFilePath;
+}
+
+void Log::syncRecords()
+{
+	if (!durableSync)
+	{
+		this->flushRecords();
+
+		return;
+	}
+
+	if (queue)
+	{
+		queue->waitUntilConsumed();
+	}
+
+	durableSync->waitDurable(writtenRecords.load(std::memory_order_acquire));
+}
+
+void Log::updateLowestVerbosityLevel()
+{
+	int lowest = static_cast<int>(verbosityLevel.load(std::memory_order_relaxed));
+	bool hasLevels = false;
+
+	for (const std::atomic<uint8_t>& categoryLevel : categoryLevels)
+	{
+		if (uint8_t level = categoryLevel.load(std::memory_order_relaxed))
+		{
+			lowest = std::min(lowest, level - 1);
+			hasLevels = true;
+		}
+	}
+
+	lowestVerbosityLevel.store(lowest, std::memory_order_relaxed);
+	hasCategoryLevels.store(hasLevels, std::memory_order_relaxed);
+}
+
+void Log::write(std::string_view data, Level type)
+{
+	bool durable = durableSync && Log::checkLevel(type, *durableLevel);
+
+	if (mappedSegmentWriter)
+	{
+		this->writeMapped(data, type);
+
+		if (durable)
+		{
+			durableSync->waitDurable(writtenRecords.load(std::memory_order_acquire));
+		}
+
+		return;
+	}
+
+	if (queue)
+	{
+		queue->pushWithPolicy(data, type);
+
+		if (durable)
+		{
+			queue->waitUntilConsumed();
+
+			durableSync->waitDurable(writtenRecords.load(std::memory_order_acquire));
+		}
+
+		return;
+	}
+
+	uint64_t written;
+
+	{
+		std::unique_lock<std::mutex> lock(writeMutex);
+
+		this->writeRecord(data, type);
+
+		written = writtenRecords.load(std::memory_order_relaxed);
+	}
+
+	if (durable)
+	{
+		durableSync->waitDurable(written);
+	}
+}
+
+void Log::writeRecord(std::string_view data, Level type)
+{
+	if (binaryLog)
+	{
+		this->writeBinaryRecord(data);
+	}
+	else
+	{
+		this->writeTextRecord(data, type);
+	}
+
+	writtenRecords.store(writtenRecords.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+	if (this->checkFlush(type))
+	{
+		this->flushStreams();
+	}
+}
+
+void Log::writeBinaryRecord(std::string_view data)
+{
+	if (currentLogFileSize + data.size() >= maxLogFileSize || BinaryLog::getTimestamp(data) >= nextDayDeadline)
+	{
+		this->nextLogFile();
+	}
+
+	size_t size = binaryLog->write(logFile, data);
+
+	currentLogFileSize += size;
+	unflushedSize += size;
+}
+
+void Log::writeTextRecord(std::string_view data, Level type)
+{
+	currentLogFileSize += data.size() + 1;
+
+	if (currentLogFileSize >= maxLogFileSize || std::chrono::system_clock::now() >= nextDayDeadline)
+	{
+		this->nextLogFile();
+	}
+
+	if (batchedFileWriter)
+	{
+		batchedFileWriter->append(data);
+	}
+	else if (uringFileWriter)
+	{
+		uringFileWriter->append(data);
+	}
+	else
+	{
+		logFile << data << '\n';
+	}
+
+	sinkDispatcher->dispatch(data, type);
+
+	unflushedSize += data.size() + 1;
+}
+
+void Log::writeMapped(std::string_view data, Level type)
+{
+	mappedSegmentWriter->append(data);
+
+	if (durableSync)
+	{
+		writtenRecords.fetch_add(1, std::memory_order_release);
+	}
+
+	if (!sinkDispatcher->accepts(type))
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(writeMutex);
+
+	sinkDispatcher->dispatch(data, type);
+}
+
+bool Log::checkFlush(Level type) const
+{
+	if (flushPolicy.everyRecord)
+	{
+		return true;
+	}
+
+	if (flushPolicy.level && Log::checkLevel(type, *flushPolicy.level))
+	{
+		return true;
+	}
+
+	if (flushPolicy.bytes && unflushedSize >= flushPolicy.bytes)
+	{
+		return true;
+	}
+
+	if (flushPolicy.interval.count() && std::chrono::steady_clock::now() - lastFlushTime >= flushPolicy.interval)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+void Log::flushLogFile()
+{
+	if (batchedFileWriter)
+	{
+		batchedFileWriter->flush();
+	}
+	else if (uringFileWriter)
+	{
+		uringFileWriter->flush();
+	}
+	else
+	{
+		logFile.flush();
+	}
+}
+
+void Log::flushStreams()
+{
+	this->flushLogFile();
+
+	unflushedSize = 0;
+
+	if (flushPolicy.interval.count())
+	{
+		lastFlushTime = std::chrono::steady_clock::now();
+	}
+}
+
+std::chrono::steady_clock::time_point Log::flushExpired()
+{
+	std::unique_lock<std::mutex> lock(writeMutex);
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (now < lastFlushTime + flushPolicy.interval)
+	{
+		return lastFlushTime + flushPolicy.interval;
+	}
+
+	if (unflushedSize)
+	{
+		this->flushStreams();
+	}
+	else
+	{
+		lastFlushTime = now;
+	}
+
+	return lastFlushTime + flushPolicy.interval;
+}
+
+bool Log::consumeRecords(size_t maxRecords)
+{
+	auto consumer = [this](RecordQueue::Record& record)
+		{
+			this->writeRecord(record.data, record.level);
+		};
+	size_t consumed = 0;
+
+	{
+		std::unique_lock<std::mutex> lock(writeMutex);
 
-Log::DateFormat Log::dateFormatFromString(const std::string& source)
+		while (consumed < maxRecords && queue->tryConsume(consumer))
+		{
+			consumed++;
+		}
+	}
+
+	if (consumed)
+	{
+		return true;
+	}
+
+	this->writeDroppedSummary();
+
+	return false;
+}
+
+void Log::writeDroppedSummary()
 {
-	if (source == "DMY")
+	size_t dropped = queue->takeDroppedCount();
+
+	if (!dropped)
 	{
-		return DateFormat::DMY;
+		return;
 	}
-	else if (source == "MDY")
+
+	RecordBuffer recordBuffer;
+	std::string& buffer = recordBuffer.get();
+
+	buffer.clear();
+
+	if (binaryLog)
 	{
-		return DateFormat::MDY;
+		this->makeBinaryRecord<true>(buffer, Level::warning, "{} messages dropped", "Log", dropped);
 	}
-	else if (source == "YMD")
+	else
 	{
-		return DateFormat::YMD;
+		this->makeRecord(buffer, Level::warning, "{} messages dropped", "Log", dropped);
 	}
 
-	throw std::invalid_argument("Can't convert source to DateFormat");
+	std::unique_lock<std::mutex> lock(writeMutex);
+
+	this->writeRecord(buffer, Level::warning);
 }
 
-std::string_view Log::getLocalTimeZoneName()
+void Log::joinSharedWriter(const Settings& settings)
 {
-#ifdef __ANDROID__
-	return tzname[0];
-#else
-	return std::chrono::get_tzdb().current_zone()->name();
-#endif
+	sharedWriter = SharedWriter::get();
+	queue = std::make_unique<RecordQueue>(settings.queueCapacity, settings.backpressurePolicy, settings.backpressureLevel, settings.overflowCapacity, sharedWriter->getWakeCounter());
+
+	sharedWriter->add(*this);
 }
 
-bool Log::verbosityFilter(Level level)
+void Log::leaveSharedWriter()
 {
-	switch (verbosityLevel)
+	if (!sharedWriter)
 	{
-	case VerbosityLevel::verbose:
-		return true;
+		return;
+	}
 
-	case VerbosityLevel::warning:
-		return level >= Level::warning;
+	sharedWriter->remove(*this);
 
-	case VerbosityLevel::error:
-		return level >= Level::error;
+	// Queue has no consumer anymore, write rest of records on this thread
+	while (this->consumeRecords(std::numeric_limits<size_t>::max()))
+	{
 
-	default:
-		throw std::runtime_error(std::format("Wrong verbosityLevel in {}", __FUNCTION__));
 	}
 
-	return false;
+	queue.reset();
+	sharedWriter.reset();
+}
+
+std::ios::openmode Log::getLogFileOpenMode() const
+{
+	return binaryLog ? std::ios::binary : std::ios::openmode();
 }
 
-void Log::write(const std::string& data, Level type)
+void Log::nextLogFile()
 {
-	if (!this->verbosityFilter(type))
+	auto deadline = std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now()) + std::chrono::days(1);
+	std::string currentDate = this->getCurrentDate();
+
+	if (currentDate != indexedDate)
 	{
-		return;
+		this->indexLogFolder(currentDate);
 	}
 
-	std::unique_lock<std::mutex> lock(writeMutex);
+	std::filesystem::path previousLogFilePath = currentLogFilePath;
 
-	currentLogFileSize += data.size();
+	nextDayDeadline = deadline;
+	currentLogFileSize = 0;
 
-	if (currentLogFileSize >= Log::logFileSize || !this->checkDate())
+	if (durableSync || segmentCompressor)
 	{
-		this->nextLogFile();
+		// Old log file may be closed on background thread, its data must reach file before sync or compression
+		this->flushLogFile();
 	}
 
-	logFile << data << std::endl;
+	bool resumed = resumableSegments.size();
 
-	switch (type)
+	if (resumed)
 	{
-	case Log::Level::info:
-	case Log::Level::warning:
-		if (outputStream)
-		{
-			(*outputStream) << data << std::endl;
-		}
+		LogSegment segment = std::move(resumableSegments.back());
 
-		break;
+		resumableSegments.pop_back();
 
-	case Log::Level::error:
-	case Log::Level::fatalError:
-		if (errorStream)
+		if (fileBackend == FileBackend::stream)
 		{
-			(*errorStream) << data << std::endl;
+			logFile.close();
+
+			logFile.open(segment.path, std::ios::app | this->getLogFileOpenMode());
 		}
-		else if (outputStream)
+
+		currentLogFilePath = std::move(segment.path);
+		currentLogFileSize = segment.size;
+
+		if (retentionEnforcer)
 		{
-			(*outputStream) << data << std::endl;
+			retentionEnforcer->reopened(currentLogFilePath);
 		}
 	}
-}
-
-void Log::nextLogFile()
-{
-	std::string currentDate = this->getCurrentDate();
-
-	for (const auto& i : std::filesystem::directory_iterator(basePath))
+	else if (!segmentPreparer || !segmentPreparer->tryTake(currentDate, logFile, currentLogFilePath))
 	{
-		std::string checkDate = i.path().filename().string();
-		checkDate.resize(dateSize);
+		currentLogFilePath = this->newLogFilePath(currentDate);
 
-		if (currentDate == checkDate)
+		if (fileBackend == FileBackend::stream)
 		{
-			for (const auto& j : std::filesystem::directory_iterator(i))
-			{
-				if (this->checkFileSize(j))
-				{
-					logFile.open(j.path(), std::ios::app);
+			logFile.close();
 
-					currentLogFilePath = j.path();
+			logFile.open(currentLogFilePath, std::ios::out | this->getLogFileOpenMode());
+		}
+	}
 
-					currentLogFileSize = std::filesystem::file_size(currentLogFilePath);
+	if (batchedFileWriter)
+	{
+		batchedFileWriter->open(currentLogFilePath);
+	}
+	else if (mappedSegmentWriter)
+	{
+		mappedSegmentWriter->open(currentLogFilePath, currentLogFileSize, nextDayDeadline);
+	}
+	else if (uringFileWriter)
+	{
+		uringFileWriter->open(currentLogFilePath);
+	}
 
-					return;
-				}
-			}
-		}
+	if (fileBackend != FileBackend::stream)
+	{
+		// Prepared log file is only used to create file ahead of rotation
+		logFile.close();
+	}
+	else if (binaryLog)
+	{
+		currentLogFileSize += binaryLog->start(logFile);
 	}
 
-	this->newLogFolder();
+	if (durableSync)
+	{
+		durableSync->open(currentLogFilePath);
+	}
 
-	logFile.close();
+	if (previousLogFilePath.extension() == logFileExtension)
+	{
+		if (retentionEnforcer)
+		{
+			retentionEnforcer->rotated(previousLogFilePath, static_cast<bool>(segmentCompressor));
+		}
 
-	logFile.open
-	(
-		(currentLogFilePath /= this->getFullCurrentDateFileName()) += Log::fileExtension
-	);
+		if (segmentCompressor)
+		{
+			segmentCompressor->request(previousLogFilePath);
+		}
+	}
 
-	currentLogFileSize = 0;
+	// Otherwise tryTake requested it
+	if (segmentPreparer && resumed)
+	{
+		segmentPreparer->request(currentDate);
+	}
 }
 
-void Log::newLogFolder()
+std::filesystem::path Log::newLogFilePath(const std::string& currentDate) const
 {
-	std::filesystem::path current(basePath / this->getCurrentDate());
+	std::filesystem::path folder(basePath / currentDate);
+	std::string fileName = this->getFullCurrentDateFileName();
+	std::filesystem::path result = (folder / fileName) += logFileExtension;
+
+	std::filesystem::create_directories(folder);
 
-	std::filesystem::create_directories(current);
+	// Compressed log file keeps name of removed log file
+	auto isUsed = [](const std::filesystem::path& path) { return std::filesystem::exists(path) || std::filesystem::exists(std::filesystem::path(path) += SegmentCompressor::getExtension()); };
 
-	currentLogFilePath = std::move(current);
+	for (size_t i = 1; isUsed(result); i++)
+	{
+		result = (folder / std::format("{}-{}", fileName, i)) += logFileExtension;
+	}
+
+	return result;
 }
 
-bool Log::checkDate() const
+void Log::indexLogFolder(const std::string& currentDate)
 {
-	std::string logFileDate = currentLogFilePath.filename().string();
+	std::filesystem::path folder(basePath / currentDate);
 
-	logFileDate.resize(dateSize);
+	indexedDate = currentDate;
 
-	return logFileDate == this->getCurrentDate();
-}
+	resumableSegments.clear();
 
-bool Log::checkFileSize(const std::filesystem::path& filePath) const
-{
-	return std::filesystem::file_size(filePath) < Log::logFileSize;
+	if (!std::filesystem::is_directory(folder))
+	{
+		return;
+	}
+
+	for (const auto& entry : std::filesystem::directory_iterator(folder))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != logFileExtension)
+		{
+			continue;
+		}
+
+		if (uintmax_t size = entry.file_size(); size < maxLogFileSize)
+		{
+			resumableSegments.push_back(LogSegment{ entry.path(), size });
+		}
+	}
 }
 
 std::string Log::getCurrentDate() const
@@ -214,43 +1187,52 @@ std::string Log::getFullCurrentDateFileName() const
 	return {};
 }
 
-std::string Log::getFullCurrentDateUTC() const
+void Log::appendFullCurrentDateUTC(std::string& buffer) const
 {
-	auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
-	std::string formatString = "[";
+	thread_local std::array<CachedDate, dateFormatsCount> cache;
 
-	switch (logDateFormat)
-	{
-	case DateFormat::DMY:
-		formatString += "{0:%d.%m.%Y-%H.%M.%S}";
+	int64_t now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+	CachedDate& cachedDate = cache[static_cast<size_t>(logDateFormat)];
 
-		break;
+	if (cachedDate.second != now)
+	{
+		std::string& text = cachedDate.text;
 
-	case DateFormat::MDY:
-		formatString += "{0:%m.%d.%Y-%H.%M.%S}";
+		text.clear();
 
-		break;
+		text += '[';
 
-	case DateFormat::YMD:
-		formatString += "{0:%Y.%m.%d-%H.%M.%S}";
+		formatFullDate(std::back_inserter(text), logDateFormat, std::chrono::seconds(now));
 
-		break;
+		text += " UTC]";
 
-	default:
-		throw std::runtime_error(std::format("Wrong DateFormat in {}", __FUNCTION__));
+		cachedDate.second = now;
 	}
 
-	formatString += " UTC]";
-
-	return std::vformat(formatString, make_format_args(now));
+	buffer += cachedDate.text;
 }
 
-std::string Log::getFullCurrentDateLocal() const
+void Log::appendFullCurrentDateLocal(std::string& buffer) const
 {
+	thread_local std::array<CachedDate, dateFormatsCount> cache;
+
+	auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+	CachedDate& cachedDate = cache[static_cast<size_t>(logDateFormat)];
+
+	if (cachedDate.second == now.time_since_epoch().count())
+	{
+		buffer += cachedDate.text;
+
+		return;
+	}
+
+	std::string& text = cachedDate.text;
+
+	text.clear();
+
 #ifdef __ANDROID__
-	auto now = std::chrono::system_clock::now();
 	time_t currentTime = std::chrono::system_clock::to_time_t(now);
-	std::string formatString;
+	const char* format = nullptr;
 
 	tm localTime;
 	localtime_r(&currentTime, &localTime);
@@ -258,17 +1240,17 @@ std::string Log::getFullCurrentDateLocal() const
 	switch (logDateFormat)
 	{
 	case DateFormat::DMY:
-		formatString += "%d.%m.%Y-%H.%M.%S";
+		format = "%d.%m.%Y-%H.%M.%S";
 
 		break;
 
 	case DateFormat::MDY:
-		formatString += "%m.%d.%Y-%H.%M.%S";
+		format = "%m.%d.%Y-%H.%M.%S";
 
 		break;
 
 	case DateFormat::YMD:
-		formatString += "%Y.%m.%d-%H.%M.%S";
+		format = "%Y.%m.%d-%H.%M.%S";
 
 		break;
 
@@ -276,86 +1258,307 @@ std::string Log::getFullCurrentDateLocal() const
 		throw std::runtime_error(std::format("Wrong DateFormat in {}", __func__));
 	}
 
-	std::string currentDateLocal(256, '\0');
-
-	currentDateLocal.resize(strftime(currentDateLocal.data(), currentDateLocal.size(), formatString.data(), &localTime));
+	char currentDateLocal[64];
 
-	return std::format("[{} {}]", currentDateLocal, Log::getLocalTimeZoneName());
+	text += '[';
+	text.append(currentDateLocal, strftime(currentDateLocal, sizeof(currentDateLocal), format, &localTime));
 #else
-	auto now = std::chrono::get_tzdb().current_zone()->to_local(std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
-	std::string_view zoneName = Log::getLocalTimeZoneName();
-	std::string formatString = "[";
+	text += '[';
 
-	switch (logDateFormat)
+	formatFullDate(std::back_inserter(text), logDateFormat, now.time_since_epoch() + localTimeZone.getOffset(now));
+#endif
+
+	text += ' ';
+	text += Log::getLocalTimeZoneName();
+	text += ']';
+
+	cachedDate.second = now.time_since_epoch().count();
+
+	buffer += text;
+}
+
+void Log::appendThreadId(std::string& buffer) const
+{
+	if (threadIdCache.name.size())
 	{
-	case DateFormat::DMY:
-		formatString += "{0:%d.%m.%Y-%H.%M.%S}";
+		buffer += threadIdCache.name;
+
+		return;
+	}
+
+	switch (threadIdFormat)
+	{
+	case ThreadIdFormat::standard:
+		if (threadIdCache.standard.empty())
+		{
+			threadIdCache.standard = (std::ostringstream() << "[thread id: " << std::this_thread::get_id() << ']').str();
+		}
+
+		buffer += threadIdCache.standard;
 
 		break;
 
-	case DateFormat::MDY:
-		formatString += "{0:%m.%d.%Y-%H.%M.%S}";
+	case ThreadIdFormat::system:
+		if (threadIdCache.system.empty())
+		{
+#ifdef __LINUX__
+			threadIdCache.system = std::format("[thread id: {}]", static_cast<int64_t>(syscall(SYS_gettid)));
+#else
+			threadIdCache.system = std::format("[thread id: {}]", static_cast<int64_t>(GetCurrentThreadId()));
+#endif
+		}
+
+		buffer += threadIdCache.system;
 
 		break;
 
-	case DateFormat::YMD:
-		formatString += "{0:%Y.%m.%d-%H.%M.%S}";
+	default:
+		throw std::runtime_error(std::format("Wrong ThreadIdFormat in {}", __FUNCTION__));
+	}
+}
+
+void Log::appendIsoCurrentDateUTC(std::string& buffer) const
+{
+	thread_local CachedDate cachedDate;
+
+	auto now = std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now());
+	auto second = std::chrono::floor<std::chrono::seconds>(now);
+
+	if (cachedDate.second != second.time_since_epoch().count())
+	{
+		cachedDate.text.clear();
+
+		formatIsoDate(std::back_inserter(cachedDate.text), second.time_since_epoch(), std::nullopt);
+
+		cachedDate.second = second.time_since_epoch().count();
+	}
+
+	appendIsoDate(buffer, cachedDate.text, (now - second).count());
+}
+
+void Log::appendIsoCurrentDateLocal(std::string& buffer) const
+{
+	thread_local CachedDate cachedDate;
+
+	auto now = std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now());
+	auto second = std::chrono::floor<std::chrono::seconds>(now);
+
+	if (cachedDate.second != second.time_since_epoch().count())
+	{
+		cachedDate.text.clear();
+
+		formatIsoDate(std::back_inserter(cachedDate.text), second.time_since_epoch(), Log::getLocalTimeZoneOffset(second));
+
+		cachedDate.second = second.time_since_epoch().count();
+	}
+
+	appendIsoDate(buffer, cachedDate.text, (now - second).count());
+}
+
+void Log::appendJsonThreadId(std::string& buffer) const
+{
+	if (threadIdCache.jsonName.size())
+	{
+		buffer += threadIdCache.jsonName;
+
+		return;
+	}
+
+	switch (threadIdFormat)
+	{
+	case ThreadIdFormat::standard:
+		if (threadIdCache.jsonStandard.empty())
+		{
+			// Representation of std::thread::id is implementation defined
+			threadIdCache.jsonStandard = (std::ostringstream() << '"' << std::this_thread::get_id() << '"').str();
+		}
+
+		buffer += threadIdCache.jsonStandard;
+
+		break;
+
+	case ThreadIdFormat::system:
+		if (threadIdCache.jsonSystem.empty())
+		{
+#ifdef __LINUX__
+			threadIdCache.jsonSystem = std::format("{}", static_cast<int64_t>(syscall(SYS_gettid)));
+#else
+			threadIdCache.jsonSystem = std::format("{}", static_cast<int64_t>(GetCurrentThreadId()));
+#endif
+		}
+
+		buffer += threadIdCache.jsonSystem;
 
 		break;
 
-	default:
-		throw std::runtime_error(std::format("Wrong DateFormat in {}", __func__));
+	default:
+		throw std::runtime_error(std::format("Wrong ThreadIdFormat in {}", __FUNCTION__));
+	}
+}
+
+void Log::initLayout(std::string_view pattern)
+{
+	layout.clear();
+
+	auto appendText = [this](std::string_view text)
+		{
+			if (layout.empty() || layout.back().operation != LayoutOperation::text)
+			{
+				layout.push_back(LayoutSegment{ LayoutOperation::text, std::string() });
+			}
+
+			layout.back().text += text;
+		};
+	bool hasMessage = false;
+
+	for (size_t i = 0; i < pattern.size();)
+	{
+		if (pattern[i] != '%')
+		{
+			size_t next = pattern.find('%', i);
+
+			if (next == std::string_view::npos)
+			{
+				next = pattern.size();
+			}
+
+			appendText(pattern.substr(i, next - i));
+
+			i = next;
+
+			continue;
+		}
+
+		if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+		{
+			appendText("%");
+
+			i += 2;
+
+			continue;
+		}
+
+		size_t end = i + 1;
+
+		while (end < pattern.size() && pattern[end] >= 'a' && pattern[end] <= 'z')
+		{
+			end++;
+		}
+
+		std::string_view field = pattern.substr(i + 1, end - i - 1);
+
+		if (field == "utc")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::utcDate, std::string() });
+		}
+		else if (field == "local")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::localDate, std::string() });
+		}
+		else if (field == "pname")
+		{
+			appendText(std::format("[process name: {}]", executablePath.string()));
+		}
+		else if (field == "pid")
+		{
+			appendText(std::format("[process id: {}]", executableProcessId));
+		}
+		else if (field == "tid")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::threadId, std::string() });
+		}
+		else if (field == "cat")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::category, std::string() });
+		}
+		else if (field == "lvl")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::level, std::string() });
+		}
+		else if (field == "msg")
+		{
+			layout.push_back(LayoutSegment{ LayoutOperation::message, std::string() });
+
+			hasMessage = true;
+		}
+		else
+		{
+			throw std::invalid_argument(std::format("Unknown layout field %{} in {}", field, pattern));
+		}
+
+		i = end;
 	}
 
-	formatString += " {1}]";
-
-	return std::vformat(formatString, std::make_format_args(now, zoneName));
-#endif
+	if (!hasMessage)
+	{
+		throw std::invalid_argument(std::format("Layout {} must contain %msg", pattern));
+	}
 }
 
-std::string Log::getProcessName() const
+void Log::initJsonLayout()
 {
-	return std::format("[process name: {}]", executablePath.string());
-}
+	layout.clear();
 
-std::string Log::getProcessId() const
-{
-	return std::format("[process id: {}]", executableProcessId);
-}
+	auto appendText = [this](std::string_view text)
+		{
+			if (layout.empty() || layout.back().operation != LayoutOperation::text)
+			{
+				layout.push_back(LayoutSegment{ LayoutOperation::text, std::string() });
+			}
 
-std::string Log::getThreadId() const
-{
-	return (std::ostringstream() << "[thread id: " << std::this_thread::get_id() << ']').str();
-}
+			layout.back().text += text;
+		};
+	auto appendField = [this, &appendText](std::string_view name, LayoutOperation operation)
+		{
+			appendText(name);
 
-void Log::initModifiers(uint64_t flags)
-{
-	modifiers.clear();
+			layout.push_back(LayoutSegment{ operation, std::string() });
+
+			appendText(",");
+		};
+
+	appendText("{");
 
 	if (flags & AdditionalInformation::utcDate)
 	{
-		modifiers.emplace_back(bind(&Log::getFullCurrentDateUTC, this));
+		appendField("\"utc\":", LayoutOperation::isoUtcDate);
 	}
 
 	if (flags & AdditionalInformation::localDate)
 	{
-		modifiers.emplace_back(bind(&Log::getFullCurrentDateLocal, this));
+		appendField("\"local\":", LayoutOperation::isoLocalDate);
 	}
 
 	if (flags & AdditionalInformation::processName)
 	{
-		modifiers.emplace_back(bind(&Log::getProcessName, this));
+		std::string processName;
+
+		JsonEscaper::append(processName, executablePath.string());
+
+		appendText(std::format("\"process\":{},", processName));
 	}
 
 	if (flags & AdditionalInformation::processId)
 	{
-		modifiers.emplace_back(bind(&Log::getProcessId, this));
+		appendText(std::format("\"pid\":{},", executableProcessId));
 	}
 
 	if (flags & AdditionalInformation::threadId)
 	{
-		modifiers.emplace_back(bind(&Log::getThreadId, this));
+		appendField("\"tid\":", LayoutOperation::jsonThreadId);
 	}
+
+	appendField("\"category\":", LayoutOperation::jsonCategory);
+	appendText("\"level\":\"");
+
+	layout.push_back(LayoutSegment{ LayoutOperation::level, std::string() });
+
+	appendText("\",\"message\":");
+
+	layout.push_back(LayoutSegment{ LayoutOperation::jsonMessage, std::string() });
+	layout.push_back(LayoutSegment{ LayoutOperation::jsonFields, std::string() });
+
+	appendText("}");
 }
 
 void Log::initExecutableInformation()
@@ -410,25 +1613,145 @@ void Log::initExecutableInformation()
 #endif
 }
 
-void Log::init(DateFormat logDateFormat, const std::filesystem::path& pathToLogs, uintmax_t defaultLogFileSize, uint64_t flags, VerbosityLevel verbosityLevel)
+void Log::init(const Settings& settings, bool defaultLogger)
 {
 	std::unique_lock<std::mutex> lock(writeMutex);
 
-	this->logDateFormat = logDateFormat;
-	basePath = pathToLogs.empty() ? std::filesystem::current_path() / "logs" : pathToLogs;
+	logDateFormat = settings.logDateFormat;
+	threadIdFormat = settings.threadIdFormat;
+	flushPolicy = settings.flushPolicy;
+	unflushedSize = 0;
+	lastFlushTime = std::chrono::steady_clock::now();
+	writtenRecords = 0;
+	durableLevel = settings.durableLevel;
+	basePath = std::filesystem::weakly_canonical(settings.pathToLogs.empty() ? std::filesystem::current_path() / "logs" : settings.pathToLogs);
+
+	// Static functions create default logger on first use, it must not find its folder taken
+	if (!defaultLogger && !instance && basePath == std::filesystem::weakly_canonical(std::filesystem::current_path() / "logs"))
+	{
+		throw std::runtime_error(std::format("{} is reserved for default logger", basePath.string()));
+	}
+
+	if (!basePathRegistry.add(basePath, *this))
+	{
+		throw std::runtime_error(std::format("{} is used by other logger", basePath.string()));
+	}
+
 	currentLogFilePath = basePath;
-	this->flags = flags;
-	this->verbosityLevel = verbosityLevel;
+	flags = settings.flags;
+	verbosityLevel = settings.verbosityLevel;
+
+	for (std::atomic<uint8_t>& categoryLevel : categoryLevels)
+	{
+		categoryLevel.store(0, std::memory_order_relaxed);
+	}
+
+	this->updateLowestVerbosityLevel();
+
+	for (const auto& [category, level] : settings.categoryVerbosityLevels)
+	{
+		this->setCategoryLevel(category, static_cast<uint8_t>(level) + 1);
+	}
+
+	maxLogFileSize = settings.logFileSize;
+
+	// Public value keeps meaning it had before Logger, size of default logger log files
+	if (defaultLogger)
+	{
+		Log::logFileSize = settings.logFileSize;
+	}
 
-	Log::logFileSize = defaultLogFileSize;
+	sinkDispatcher = std::make_unique<SinkDispatcher>();
+	suppressionReporter = std::make_unique<SuppressionReporter>(*this);
 
-	this->initModifiers(flags);
 	this->initExecutableInformation();
 
+	if (settings.jsonLog && !settings.binaryLog)
+	{
+		this->initJsonLayout();
+	}
+	else
+	{
+		this->initLayout(settings.layout.empty() ? Log::layoutFromFlags(flags) : settings.layout);
+	}
+
 #ifdef __ANDROID__
 	tzset();
+#else
+	if (std::ranges::any_of(layout, [](const LayoutSegment& segment) { return segment.operation == LayoutOperation::localDate || segment.operation == LayoutOperation::isoLocalDate; }))
+	{
+		localTimeZone.resolve();
+	}
+#endif
+
+	if (settings.retentionPolicy.maxTotalSize || settings.retentionPolicy.maxAge.count() || settings.retentionPolicy.maxLogFiles)
+	{
+		// Indexes existing log files before any new log file is created
+		retentionEnforcer = std::make_unique<RetentionEnforcer>(basePath, settings.retentionPolicy);
+	}
+
+	if (settings.prepareNextLogFile)
+	{
+		segmentPreparer = std::make_unique<SegmentPreparer>(*this, settings.preallocateLogFiles ? settings.logFileSize : 0);
+	}
+
+	fileBackend = FileBackend::stream;
+	logFileExtension = settings.binaryLog ? Log::binaryFileExtension : Log::fileExtension;
+
+	if (settings.binaryLog)
+	{
+		binaryLog = std::make_unique<BinaryLog>(*this);
+	}
+
+#ifdef __LINUX__
+	if (!binaryLog)
+	{
+		fileBackend = settings.fileBackend;
+	}
+
+	if (fileBackend == FileBackend::batched)
+	{
+		batchedFileWriter = std::make_unique<BatchedFileWriter>(settings.batchSize);
+	}
+	else if (fileBackend == FileBackend::mapped)
+	{
+		MappedSegmentWriter::recover(basePath);
+
+		mappedSegmentWriter = std::make_unique<MappedSegmentWriter>(*this);
+	}
+	else if (fileBackend == FileBackend::uring)
+	{
+		try
+		{
+			uringFileWriter = std::make_unique<UringFileWriter>(settings.batchSize);
+		}
+		catch (const std::exception&)
+		{
+			// Reported by getFileBackend
+			fileBackend = FileBackend::batched;
+
+			batchedFileWriter = std::make_unique<BatchedFileWriter>(settings.batchSize);
+		}
+	}
 #endif
 
+	if (durableLevel)
+	{
+		durableSync = std::make_unique<DurableSync>(*this, settings.durableMaxWait);
+	}
+
+	if (settings.compressRotatedLogFiles)
+	{
+		if (SegmentCompressor::isAvailable())
+		{
+			segmentCompressor = std::make_unique<SegmentCompressor>(*this);
+		}
+		else
+		{
+			std::cerr << "Log compression is not available, zstd and zlib were not found at configure time" << std::endl;
+		}
+	}
+
 	if (std::filesystem::exists(currentLogFilePath) && std::filesystem::is_directory(currentLogFilePath))
 	{
 		this->nextLogFile();
@@ -443,29 +1766,225 @@ void Log::init(DateFormat logDateFormat, const std::filesystem::path& pathToLogs
 
 		this->nextLogFile();
 	}
+
+	if (settings.writeMode == WriteMode::asynchronous && !mappedSegmentWriter)
+	{
+		this->joinSharedWriter(settings);
+	}
+
+	if (!flushPolicy.everyRecord && flushPolicy.interval.count() && !mappedSegmentWriter)
+	{
+		flushTimer = std::make_unique<FlushTimer>(*this);
+	}
 }
 
 Log::Log() :
-	outputStream(nullptr),
-	errorStream(nullptr)
+	Log(Settings(), true)
+{
+
+}
+
+Log::Log(const Settings& settings, bool defaultLogger)
+{
+	try
+	{
+		this->init(settings, defaultLogger);
+	}
+	catch (...)
+	{
+		basePathRegistry.remove(*this);
+
+		throw;
+	}
+}
+
+Log::~Log()
+{
+	flushTimer.reset();
+
+	suppressionReporter.reset();
+
+	this->leaveSharedWriter();
+
+	mappedSegmentWriter.reset();
+
+	if (durableSync)
+	{
+		this->flushLogFile();
+
+		durableSync.reset();
+	}
+
+	segmentPreparer.reset();
+
+	segmentCompressor.reset();
+
+	retentionEnforcer.reset();
+
+	sinkDispatcher.reset();
+
+	basePathRegistry.remove(*this);
+}
+
+Log::Logger::Logger(const Settings& settings) :
+	log(new Log(settings, false))
+{
+
+}
+
+void Log::Logger::setVerbosityLevel(VerbosityLevel level)
+{
+	log->setLevel(level);
+}
+
+void Log::Logger::setVerbosityLevel(std::string_view category, VerbosityLevel level)
+{
+	log->setCategoryLevel(category, static_cast<uint8_t>(level) + 1);
+}
+
+void Log::Logger::resetVerbosityLevel(std::string_view category)
+{
+	log->setCategoryLevel(category, 0);
+}
+
+void Log::Logger::addSink(const std::shared_ptr<Sink>& sink)
+{
+	log->attachSink(sink);
+}
+
+bool Log::Logger::removeSink(const std::shared_ptr<Sink>& sink)
+{
+	return log->detachSink(sink);
+}
+
+void Log::Logger::flush()
+{
+	log->flushRecords();
+}
+
+void Log::Logger::sync()
+{
+	log->syncRecords();
+}
+
+Log::DurabilityStatistics Log::Logger::getDurabilityStatistics() const
+{
+	return log->durableSync ? log->durableSync->getStatistics() : DurabilityStatistics();
+}
+
+std::filesystem::path Log::Logger::getCurrentLogFilePath() const
+{
+	return log->getLogFilePath();
+}
+
+Log::FileBackend Log::Logger::getFileBackend() const
+{
+	return log->fileBackend;
+}
+
+Log::Logger::~Logger() = default;
+
+Log::EverySite::EverySite() :
+	calls(0)
+{
+
+}
+
+Log::CategorySite::CategorySite(std::string_view category) :
+	name(category),
+	id(getCategoryRegistry().intern(category, Log::maxCategoryLevels))
+{
+	if (id == CategoryRegistry::noId)
+	{
+		id = Log::maxCategoryLevels;
+	}
+}
+
+uint64_t Log::RateLimitSite::getWindow(std::chrono::nanoseconds period)
+{
+	int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	return static_cast<uint64_t>(now / std::max<int64_t>(period.count(), 1)) << RateLimitSite::windowShift;
+}
+
+uint64_t Log::RateLimitSite::takeSuppressed(uint32_t count, uint64_t window)
+{
+	uint64_t current = state.load(std::memory_order_relaxed);
+
+	while ((current & ~RateLimitSite::recordsMask) == window && (current & RateLimitSite::recordsMask) > count)
+	{
+		if (state.compare_exchange_weak(current, window | count, std::memory_order_relaxed))
+		{
+			return (current & RateLimitSite::recordsMask) - count;
+		}
+	}
+
+	return 0;
+}
+
+Log::RateLimitSite::RateLimitSite() :
+	state(0)
 {
-	this->init();
+
 }
 
-Log::Log(DateFormat logDateFormat, const std::filesystem::path& pathToLogs, uintmax_t defaultLogFileSize, uint64_t flags, VerbosityLevel verbosityLevel) :
-	outputStream(nullptr),
-	errorStream(nullptr)
+Log::RateLimitSite::~RateLimitSite()
 {
-	this->init(logDateFormat, pathToLogs, defaultLogFileSize, flags);
+	if (instance && instance->suppressionReporter)
+	{
+		instance->suppressionReporter->remove(*this);
+	}
 }
 
 Log& Log::operator +=(const std::string& message)
 {
+	if (!this->verbosityFilter(Level::info, "LogTemp"))
+	{
+		return *this;
+	}
+
 	this->log(Level::info, "{}", "LogTemp", message);
 
 	return *this;
 }
 
+std::string& Log::getRecordBuffer()
+{
+	thread_local std::string buffer = []()
+		{
+			std::string result;
+
+			result.reserve(Log::additionalInformationSize * 2);
+
+			return result;
+		}();
+
+	return buffer;
+}
+
+Log::RecordBuffer::RecordBuffer() :
+	buffer(&nested)
+{
+	if (!recordBufferUsed)
+	{
+		recordBufferUsed = true;
+		buffer = &Log::getRecordBuffer();
+	}
+}
+
+std::string& Log::RecordBuffer::get()
+{
+	return *buffer;
+}
+
+Log::RecordBuffer::~RecordBuffer()
+{
+	if (buffer != &nested)
+	{
+		recordBufferUsed = false;
+	}
+}
+
 Log& Log::getInstance()
 {
 	if (!instance)
@@ -508,32 +2027,56 @@ uint64_t Log::createFlags(const std::vector<std::string>& values)
 
 void Log::configure(DateFormat logDateFormat, const std::filesystem::path& pathToLogs, uintmax_t defaultLogFileSize, uint64_t flags, VerbosityLevel verbosityLevel)
 {
-	if (instance)
-	{
-		return;
-	}
+	Settings settings;
 
-	instance = std::unique_ptr<Log>(new Log(logDateFormat, pathToLogs, defaultLogFileSize, flags, verbosityLevel));
+	settings.logDateFormat = logDateFormat;
+	settings.pathToLogs = pathToLogs;
+	settings.logFileSize = defaultLogFileSize;
+	settings.flags = flags;
+	settings.verbosityLevel = verbosityLevel;
+
+	Log::configure(settings);
 }
 
 void Log::configure(const std::string& logDateFormat, const std::filesystem::path& pathToLogs, uintmax_t defaultLogFileSize, uint64_t flags, VerbosityLevel verbosityLevel)
+{
+	Log::configure(Log::dateFormatFromString(logDateFormat), pathToLogs, defaultLogFileSize, flags, verbosityLevel);
+}
+
+void Log::configure(const Settings& settings)
 {
 	if (instance)
 	{
 		return;
 	}
 
-	instance = std::unique_ptr<Log>(new Log(Log::dateFormatFromString(logDateFormat), pathToLogs, defaultLogFileSize, flags, verbosityLevel));
+	instance = std::unique_ptr<Log>(new Log(settings, true));
 }
 
 void Log::duplicateLog(std::ostream& outputStream)
 {
-	Log::getInstance().outputStream = &outputStream;
+	Log& log = Log::getInstance();
+	std::unique_lock<std::mutex> lock(log.writeMutex);
+
+	log.sinkDispatcher->setOutputStream(outputStream);
 }
 
 void Log::duplicateErrorLog(std::ostream& errorStream)
 {
-	Log::getInstance().errorStream = &errorStream;
+	Log& log = Log::getInstance();
+	std::unique_lock<std::mutex> lock(log.writeMutex);
+
+	log.sinkDispatcher->setErrorStream(errorStream);
+}
+
+void Log::addSink(const std::shared_ptr<Sink>& sink)
+{
+	Log::getInstance().attachSink(sink);
+}
+
+bool Log::removeSink(const std::shared_ptr<Sink>& sink)
+{
+	return Log::getInstance().detachSink(sink);
 }
 
 bool Log::isValid()
@@ -543,12 +2086,62 @@ bool Log::isValid()
 
 void Log::setVerbosityLevel(VerbosityLevel level)
 {
-	Log::getInstance().verbosityLevel = level;
+	Log::getInstance().setLevel(level);
+}
+
+void Log::setVerbosityLevel(std::string_view category, VerbosityLevel level)
+{
+	Log::getInstance().setCategoryLevel(category, static_cast<uint8_t>(level) + 1);
+}
+
+void Log::resetVerbosityLevel(std::string_view category)
+{
+	Log::getInstance().setCategoryLevel(category, 0);
+}
+
+void Log::setThreadName(std::string_view name)
+{
+	if (name.empty())
+	{
+		threadIdCache.name.clear();
+		threadIdCache.jsonName.clear();
+		threadIdCache.binaryThreads.fill(std::numeric_limits<uint32_t>::max());
+
+		return;
+	}
+
+	threadIdCache.name = std::format("[thread id: {}]", name);
+	threadIdCache.jsonName.clear();
+	threadIdCache.binaryThreads.fill(std::numeric_limits<uint32_t>::max());
+
+	JsonEscaper::append(threadIdCache.jsonName, name);
+}
+
+void Log::decodeBinaryLog(std::istream& input, std::ostream& output)
+{
+	BinaryLog::decode(input, output);
 }
 
-const std::filesystem::path& Log::getCurrentLogFilePath()
+void Log::flush()
 {
-	return Log::getInstance().currentLogFilePath;
+	Log::getInstance().flushRecords();
+}
+
+void Log::sync()
+{
+	Log::getInstance().syncRecords();
+}
+
+Log::DurabilityStatistics Log::getDurabilityStatistics()
+{
+	Log& log = Log::getInstance();
+
+	return log.durableSync ? log.durableSync->getStatistics() : DurabilityStatistics();
+}
+
+std::filesystem::path Log::getCurrentLogFilePath()
+{
+	return Log::getInstance().getLogFilePath();
 }
 
 const std::filesystem::path& Log::getExecutablePath()
@@ -560,3 +2153,13 @@ int64_t Log::getExecutableProcessId()
 {
 	return Log::getInstance().executableProcessId;
 }
+
+Log::FileBackend Log::getFileBackend()
+{
+	return Log::getInstance().fileBackend;
+}
+
+std::string_view Log::getCompressedLogFileExtension()
+{
+	return SegmentCompressor::isAvailable() ? SegmentCompressor::getExtension() : std::string_view();
+}
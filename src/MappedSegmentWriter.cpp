@@ -0,0 +1,336 @@
+#include "MappedSegmentWriter.h"
+
+#ifdef __LINUX__
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+void Log::MappedSegmentWriter::rotate()
+{
+	std::unique_lock<std::mutex> lock(log.writeMutex);
+
+	log.nextLogFile();
+}
+
+void Log::MappedSegmentWriter::retire(Segment& segment)
+{
+	// Writers with reservations below sealedSize may still copy their records
+	while (segment.committed.load(std::memory_order_acquire) < segment.sealedSize)
+	{
+		std::this_thread::yield();
+	}
+
+	munmap(segment.data, segment.capacity);
+
+	if (ftruncate(segment.descriptor, static_cast<off_t>(segment.sealedSize)))
+	{
+		std::cerr << "Can't truncate log file: " << std::strerror(errno) << std::endl;
+	}
+
+	::close(segment.descriptor);
+
+	segment.data = nullptr;
+	segment.descriptor = -1;
+}
+
+void Log::MappedSegmentWriter::recoverLogFolder(const std::filesystem::path& logFolder)
+{
+	static constexpr size_t chunkSize = 64 * 1024;
+
+	std::error_code errorCode;
+	std::vector<char> chunk(chunkSize);
+
+	for (const auto& entry : std::filesystem::directory_iterator(logFolder, errorCode))
+	{
+		if (!entry.is_regular_file() || entry.path().extension() != Log::fileExtension)
+		{
+			continue;
+		}
+
+		int descriptor = ::open(entry.path().c_str(), O_RDWR | O_CLOEXEC);
+
+		if (descriptor == -1)
+		{
+			continue;
+		}
+
+		off_t end = lseek(descriptor, 0, SEEK_END);
+		char last = 0;
+
+		// Log files written completely end with line break, mapped log files of crashed process end with zeros
+		if (end > 0 && pread(descriptor, &last, 1, end - 1) == 1 && !last)
+		{
+			off_t size = end;
+
+			while (size > 0)
+			{
+				off_t offset = std::max<off_t>(size - static_cast<off_t>(chunkSize), 0);
+				ssize_t count = pread(descriptor, chunk.data(), size - offset, offset);
+
+				if (count != size - offset)
+				{
+					break;
+				}
+
+				auto it = std::find_if(chunk.rbegin() + (chunkSize - count), chunk.rend(), [](char symbol) { return symbol; });
+
+				if (it != chunk.rend())
+				{
+					size = offset + (chunk.rend() - it);
+
+					break;
+				}
+
+				size = offset;
+			}
+
+			if (ftruncate(descriptor, size))
+			{
+				std::cerr << "Can't truncate " << entry.path().string() << ": " << std::strerror(errno) << std::endl;
+			}
+		}
+
+		::close(descriptor);
+	}
+}
+
+void Log::MappedSegmentWriter::reclaim()
+{
+	std::unique_lock<std::mutex> lock(retiredMutex);
+
+	// Writers load current after they are counted, without active writers nobody holds retired segment
+	if (!activeAppends.load())
+	{
+		retiredSegments.clear();
+
+		hasRetired.store(false);
+	}
+}
+
+void Log::MappedSegmentWriter::appendRecord(std::string_view data)
+{
+	uint64_t size = data.size() + 1;
+
+	activeAppends.fetch_add(1);
+
+	while (true)
+	{
+		Segment* segment = current.load();
+		uint64_t offset;
+
+		if (std::chrono::system_clock::now() >= segment->deadline)
+		{
+			// Seal segment so every following reservation fails
+			offset = segment->reserved.fetch_add(segment->capacity + 1, std::memory_order_relaxed);
+		}
+		else
+		{
+			offset = segment->reserved.fetch_add(size, std::memory_order_relaxed);
+
+			if (offset + size <= segment->capacity)
+			{
+				std::memcpy(segment->data + offset, data.data(), size - 1);
+
+				segment->data[offset + size - 1] = '\n';
+
+				segment->committed.fetch_add(size, std::memory_order_release);
+
+				break;
+			}
+		}
+
+		if (offset <= segment->capacity)
+		{
+			// First reservation past the end, this writer rotates
+			segment->sealedSize = offset;
+
+			// Rotating writer loads current again after rotation, so it doesn't hold retired segment
+			activeAppends.fetch_sub(1, std::memory_order_release);
+
+			this->rotate();
+
+			activeAppends.fetch_add(1);
+		}
+		else
+		{
+			current.wait(segment, std::memory_order_acquire);
+		}
+	}
+
+	// Last writer frees segments retired while it was inside append
+	if (activeAppends.fetch_sub(1) == 1 && hasRetired.load())
+	{
+		this->reclaim();
+	}
+}
+
+void Log::MappedSegmentWriter::recover(const std::filesystem::path& basePath)
+{
+	std::error_code errorCode;
+
+	// Crashed process may have written into folder of any previous day
+	for (const auto& entry : std::filesystem::directory_iterator(basePath, errorCode))
+	{
+		if (entry.is_directory())
+		{
+			MappedSegmentWriter::recoverLogFolder(entry.path());
+		}
+	}
+}
+
+Log::MappedSegmentWriter::MappedSegmentWriter(Log& log) :
+	log(log),
+	current(nullptr),
+	activeAppends(0),
+	hasRetired(false)
+{
+
+}
+
+void Log::MappedSegmentWriter::open(const std::filesystem::path& logFilePath, uint64_t size, std::chrono::system_clock::time_point deadline)
+{
+	std::unique_ptr<Segment> segment = std::make_unique<Segment>();
+	uint64_t capacity = std::max<uint64_t>(log.maxLogFileSize, size + 1);
+
+	segment->descriptor = ::open(logFilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+	if (segment->descriptor == -1)
+	{
+		throw std::runtime_error(std::format("Can't open {}: {}", logFilePath.string(), std::strerror(errno)));
+	}
+
+	if (ftruncate(segment->descriptor, static_cast<off_t>(capacity)))
+	{
+		int error = errno;
+
+		::close(segment->descriptor);
+
+		throw std::runtime_error(std::format("Can't resize {}: {}", logFilePath.string(), std::strerror(error)));
+	}
+
+	void* data = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, segment->descriptor, 0);
+
+	if (data == MAP_FAILED)
+	{
+		int error = errno;
+
+		ftruncate(segment->descriptor, static_cast<off_t>(size));
+
+		::close(segment->descriptor);
+
+		throw std::runtime_error(std::format("Can't map {}: {}", logFilePath.string(), std::strerror(error)));
+	}
+
+	segment->data = static_cast<char*>(data);
+	segment->capacity = capacity;
+	segment->sealedSize = 0;
+	segment->deadline = deadline;
+	segment->reserved.store(size, std::memory_order_relaxed);
+	segment->committed.store(size, std::memory_order_relaxed);
+
+	current.store(segment.get());
+
+	std::unique_ptr<Segment> previous = std::exchange(currentSegment, std::move(segment));
+
+	current.notify_all();
+
+	if (previous)
+	{
+		this->retire(*previous);
+
+		{
+			std::unique_lock<std::mutex> lock(retiredMutex);
+
+			retiredSegments.push_back(std::move(previous));
+
+			hasRetired.store(true);
+		}
+
+		this->reclaim();
+	}
+}
+
+void Log::MappedSegmentWriter::append(std::string_view data)
+{
+	// Each line must fit into empty segment
+	uint64_t maxLineSize = std::max<uint64_t>(log.maxLogFileSize, 2) - 1;
+
+	while (data.size() > maxLineSize)
+	{
+		this->appendRecord(data.substr(0, maxLineSize));
+
+		data.remove_prefix(maxLineSize);
+	}
+
+	this->appendRecord(data);
+}
+
+Log::MappedSegmentWriter::~MappedSegmentWriter()
+{
+	if (currentSegment)
+	{
+		currentSegment->sealedSize = std::min(currentSegment->reserved.load(std::memory_order_acquire), currentSegment->capacity);
+
+		this->retire(*currentSegment);
+	}
+}
+#else
+void Log::MappedSegmentWriter::recoverLogFolder(const std::filesystem::path& logFolder)
+{
+
+}
+
+void Log::MappedSegmentWriter::rotate()
+{
+
+}
+
+void Log::MappedSegmentWriter::retire(Segment& segment)
+{
+
+}
+
+void Log::MappedSegmentWriter::reclaim()
+{
+
+}
+
+void Log::MappedSegmentWriter::appendRecord(std::string_view data)
+{
+
+}
+
+void Log::MappedSegmentWriter::recover(const std::filesystem::path& basePath)
+{
+
+}
+
+Log::MappedSegmentWriter::MappedSegmentWriter(Log& log) :
+	log(log),
+	current(nullptr),
+	activeAppends(0),
+	hasRetired(false)
+{
+	throw std::runtime_error("FileBackend::mapped is only available on POSIX systems");
+}
+
+void Log::MappedSegmentWriter::open(const std::filesystem::path& logFilePath, uint64_t size, std::chrono::system_clock::time_point deadline)
+{
+
+}
+
+void Log::MappedSegmentWriter::append(std::string_view data)
+{
+
+}
+
+Log::MappedSegmentWriter::~MappedSegmentWriter()
+{
+
+}
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Log.h"
+
+/**
+ * @brief Log file backend that maps whole log file into memory. Writers reserve space with one atomic add and copy records without locks. POSIX only, constructor throws on other systems
+ */
+class Log::MappedSegmentWriter
+{
+private:
+	static inline constexpr size_t cacheLineSize = 64;
+
+	struct Segment
+	{
+		alignas(cacheLineSize) std::atomic<uint64_t> reserved;
+		alignas(cacheLineSize) std::atomic<uint64_t> committed;
+		char* data;
+		uint64_t capacity;
+		uint64_t sealedSize;
+		std::chrono::system_clock::time_point deadline;
+		int descriptor;
+	};
+
+private:
+	Log& log;
+	std::atomic<Segment*> current;
+	alignas(cacheLineSize) std::atomic<uint64_t> activeAppends; /// Writers that may still hold pointer to retired segment
+	std::unique_ptr<Segment> currentSegment; /// Owner of current, changed under writeMutex
+	std::mutex retiredMutex;
+	std::vector<std::unique_ptr<Segment>> retiredSegments; /// Unmapped segments that aren't freed yet
+	std::atomic<bool> hasRetired;
+
+private:
+	static void recoverLogFolder(const std::filesystem::path& logFolder);
+
+	void rotate();
+
+	void retire(Segment& segment);
+
+	void reclaim();
+
+	void appendRecord(std::string_view data);
+
+public:
+	/**
+	 * @brief Truncate log files left mapped by crashed process to their real length. Log files in every folder under basePath are checked
+	 */
+	static void recover(const std::filesystem::path& basePath);
+
+public:
+	/**
+	 * @param log Owner of log files
+	 */
+	MappedSegmentWriter(Log& log);
+
+	/**
+	 * @brief Map logFilePath and retire current segment. Retired segments are freed when no writer is inside append. Called under writeMutex by rotation
+	 * @param size Size of existing records in logFilePath
+	 * @param deadline After this time next append rotates
+	 */
+	void open(const std::filesystem::path& logFilePath, uint64_t size, std::chrono::system_clock::time_point deadline);
+
+	/**
+	 * @brief Copy record and line break into current segment. Rotates when record doesn't fit, record longer than log file is split into several lines. Must not be called under writeMutex
+	 */
+	void append(std::string_view data);
+
+	~MappedSegmentWriter();
+};
@@ -0,0 +1,182 @@
+#include "RecordQueue.h"
+
+#include <bit>
+#include <algorithm>
+
+void Log::RecordQueue::published()
+{
+	wakeCounter.fetch_add(1, std::memory_order_release);
+	wakeCounter.notify_one();
+}
+
+bool Log::RecordQueue::spill(std::string_view data, Level level)
+{
+	{
+		std::unique_lock<std::mutex> lock(overflowMutex);
+
+		if (overflow.size() >= overflowCapacity)
+		{
+			return false;
+		}
+
+		overflow.push_back(Record{ std::string(data), level });
+
+		// Consumer takes overflow under same mutex, record is counted before it can be consumed
+		acceptedCount.fetch_add(1, std::memory_order_release);
+
+		overflowSize.store(overflow.size(), std::memory_order_release);
+	}
+
+	this->published();
+
+	return true;
+}
+
+void Log::RecordQueue::drop()
+{
+	droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+Log::RecordQueue::RecordQueue(size_t capacity, BackpressurePolicy policy, VerbosityLevel backpressureLevel, size_t overflowCapacity, std::atomic<size_t>& wakeCounter) :
+	cells(std::make_unique<Cell[]>(std::bit_ceil(std::max<size_t>(capacity, 2)))),
+	mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+	policy(policy),
+	backpressureLevel(backpressureLevel),
+	overflowCapacity(overflowCapacity),
+	enqueuePosition(0),
+	acceptedCount(0),
+	consumedCount(0),
+	droppedCount(0),
+	overflowSize(0),
+	dequeuePosition(0),
+	wakeCounter(wakeCounter)
+{
+	for (size_t i = 0; i <= mask; i++)
+	{
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+bool Log::RecordQueue::tryPush(std::string_view data, Level level)
+{
+	size_t position = enqueuePosition.load(std::memory_order_relaxed);
+	Cell* cell = nullptr;
+
+	while (true)
+	{
+		cell = &cells[position & mask];
+
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+		if (!difference)
+		{
+			if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			return false;
+		}
+		else
+		{
+			position = enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->record.data.assign(data);
+	cell->record.level = level;
+
+	// Counted before consumer can take it, otherwise waitUntilConsumed of other producer could miss own record
+	acceptedCount.fetch_add(1, std::memory_order_release);
+
+	cell->sequence.store(position + 1, std::memory_order_release);
+
+	this->published();
+
+	return true;
+}
+
+void Log::RecordQueue::push(std::string_view data, Level level)
+{
+	while (true)
+	{
+		size_t consumed = consumedCount.load(std::memory_order_acquire);
+
+		if (this->tryPush(data, level))
+		{
+			return;
+		}
+
+		consumedCount.wait(consumed, std::memory_order_acquire);
+	}
+}
+
+void Log::RecordQueue::pushWithPolicy(std::string_view data, Level level)
+{
+	switch (policy)
+	{
+	case BackpressurePolicy::block:
+		this->push(data, level);
+
+		break;
+
+	case BackpressurePolicy::dropNewest:
+		if (!this->tryPush(data, level))
+		{
+			this->drop();
+		}
+
+		break;
+
+	case BackpressurePolicy::dropBelowLevel:
+		if (Log::checkLevel(level, backpressureLevel))
+		{
+			this->push(data, level);
+		}
+		else if (!this->tryPush(data, level))
+		{
+			this->drop();
+		}
+
+		break;
+
+	case BackpressurePolicy::spillToOverflowBuffer:
+		if (overflowSize.load(std::memory_order_acquire) || !this->tryPush(data, level))
+		{
+			if (!this->spill(data, level))
+			{
+				this->drop();
+			}
+		}
+
+		break;
+
+	default:
+		throw std::runtime_error(std::format("Wrong BackpressurePolicy in {}", __FUNCTION__));
+	}
+}
+
+void Log::RecordQueue::waitUntilConsumed()
+{
+	size_t target = acceptedCount.load(std::memory_order_acquire);
+
+	while (true)
+	{
+		size_t consumed = consumedCount.load(std::memory_order_acquire);
+
+		if (consumed >= target)
+		{
+			return;
+		}
+
+		consumedCount.wait(consumed, std::memory_order_acquire);
+	}
+}
+
+size_t Log::RecordQueue::takeDroppedCount()
+{
+	return droppedCount.exchange(0, std::memory_order_relaxed);
+}
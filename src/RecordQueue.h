@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Log.h"
+
+#include <memory>
+
+/**
+ * @brief Bounded lock-free multi-producer single-consumer queue of finished records
+ */
+class Log::RecordQueue
+{
+public:
+	struct Record
+	{
+		std::string data;
+		Level level;
+	};
+
+private:
+	static inline constexpr size_t cacheLineSize = 64;
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		Record record;
+	};
+
+private:
+	std::unique_ptr<Cell[]> cells;
+	size_t mask;
+	BackpressurePolicy policy;
+	VerbosityLevel backpressureLevel;
+	size_t overflowCapacity;
+	alignas(cacheLineSize) std::atomic<size_t> enqueuePosition;
+	alignas(cacheLineSize) std::atomic<size_t> acceptedCount;
+	alignas(cacheLineSize) std::atomic<size_t> consumedCount;
+	alignas(cacheLineSize) std::atomic<size_t> droppedCount;
+	alignas(cacheLineSize) std::atomic<size_t> overflowSize;
+	std::mutex overflowMutex;
+	std::vector<Record> overflow;
+	std::vector<Record> overflowToConsume;
+	size_t dequeuePosition;
+	std::atomic<size_t>& wakeCounter;
+
+private:
+	void published();
+
+	bool spill(std::string_view data, Level level);
+
+	void drop();
+
+public:
+	/**
+	 * @param capacity Rounded up to power of two
+	 * @param policy What to do with records when queue is full
+	 * @param backpressureLevel Records at or above this level are never dropped by BackpressurePolicy::dropBelowLevel
+	 * @param overflowCapacity Maximum number of records in overflow buffer for BackpressurePolicy::spillToOverflowBuffer
+	 * @param wakeCounter Counter of consumer that serves several queues, incremented and notified on every push
+	 */
+	RecordQueue(size_t capacity, BackpressurePolicy policy, VerbosityLevel backpressureLevel, size_t overflowCapacity, std::atomic<size_t>& wakeCounter);
+
+	/**
+	 * @brief Copy record into free cell
+	 * @return false if queue is full
+	 */
+	bool tryPush(std::string_view data, Level level);
+
+	/**
+	 * @brief Push record, wait for free cell if queue is full
+	 */
+	void push(std::string_view data, Level level);
+
+	/**
+	 * @brief Push record with BackpressurePolicy
+	 */
+	void pushWithPolicy(std::string_view data, Level level);
+
+	/**
+	 * @brief Consume oldest record in place. Only one thread may consume
+	 * @return false if queue and overflow buffer are empty
+	 */
+	template<typename ConsumerT>
+	bool tryConsume(ConsumerT&& consumer);
+
+	/**
+	 * @brief Wait until all records pushed before this call are consumed
+	 */
+	void waitUntilConsumed();
+
+	/**
+	 * @brief Get number of dropped records since last call
+	 */
+	size_t takeDroppedCount();
+
+	~RecordQueue() = default;
+};
+
+template<typename ConsumerT>
+bool Log::RecordQueue::tryConsume(ConsumerT&& consumer)
+{
+	Cell& cell = cells[dequeuePosition & mask];
+	size_t consumed = 0;
+
+	if (cell.sequence.load(std::memory_order_acquire) == dequeuePosition + 1)
+	{
+		consumer(cell.record);
+
+		cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+
+		dequeuePosition++;
+		consumed = 1;
+	}
+	else if (overflowSize.load(std::memory_order_acquire))
+	{
+		{
+			std::unique_lock<std::mutex> lock(overflowMutex);
+
+			overflowToConsume.swap(overflow);
+
+			overflowSize.store(0, std::memory_order_release);
+		}
+
+		for (Record& record : overflowToConsume)
+		{
+			consumer(record);
+		}
+
+		consumed = overflowToConsume.size();
+
+		overflowToConsume.clear();
+	}
+	else
+	{
+		return false;
+	}
+
+	consumedCount.fetch_add(consumed, std::memory_order_release);
+	consumedCount.notify_all();
+
+	return true;
+}
@@ -0,0 +1,292 @@
+#include "RetentionEnforcer.h"
+
+#include <algorithm>
+
+std::filesystem::path Log::RetentionEnforcer::getLogFilePath(const std::filesystem::path& path)
+{
+	std::filesystem::path result(path);
+
+	if (result.extension() == ".tmp")
+	{
+		result.replace_extension();
+	}
+
+	if (result.extension() == ".index")
+	{
+		result.replace_extension();
+	}
+
+	if (result.extension() == ".gz" || result.extension() == ".zst")
+	{
+		result.replace_extension();
+	}
+
+	if (result.extension() != Log::fileExtension && result.extension() != Log::binaryFileExtension)
+	{
+		return {};
+	}
+
+	return result;
+}
+
+void Log::RetentionEnforcer::measure(TrackedLogFile& logFile)
+{
+	logFile.size = 0;
+	logFile.lastWriteTime = std::filesystem::file_time_type::min();
+
+	for (std::string_view suffix : suffixes)
+	{
+		std::filesystem::path path = std::filesystem::path(logFile.path) += suffix;
+		std::error_code errorCode;
+		uintmax_t size = std::filesystem::file_size(path, errorCode);
+
+		if (errorCode)
+		{
+			continue;
+		}
+
+		logFile.size += size;
+
+		// Suffixes start with log file and compressed log file, index and temporary files are written later
+		if (logFile.lastWriteTime == std::filesystem::file_time_type::min())
+		{
+			logFile.lastWriteTime = std::filesystem::last_write_time(path, errorCode);
+		}
+	}
+}
+
+void Log::RetentionEnforcer::removeFiles(const std::filesystem::path& logFilePath)
+{
+	for (std::string_view suffix : suffixes)
+	{
+		std::error_code errorCode;
+
+		std::filesystem::remove(std::filesystem::path(logFilePath) += suffix, errorCode);
+	}
+}
+
+void Log::RetentionEnforcer::index()
+{
+	std::unordered_map<std::string, TrackedLogFile> found;
+	std::vector<TrackedLogFile> logFiles;
+	std::error_code errorCode;
+
+	for (const auto& folder : std::filesystem::directory_iterator(basePath, errorCode))
+	{
+		if (!folder.is_directory(errorCode))
+		{
+			continue;
+		}
+
+		for (const auto& entry : std::filesystem::directory_iterator(folder.path(), errorCode))
+		{
+			if (!entry.is_regular_file(errorCode))
+			{
+				continue;
+			}
+
+			if (std::filesystem::path logFilePath = RetentionEnforcer::getLogFilePath(entry.path()); !logFilePath.empty())
+			{
+				found.try_emplace(logFilePath.string(), TrackedLogFile{ logFilePath, 0, std::filesystem::file_time_type::min(), false });
+			}
+		}
+	}
+
+	logFiles.reserve(found.size());
+
+	for (auto& [_, logFile] : found)
+	{
+		RetentionEnforcer::measure(logFile);
+
+		logFiles.push_back(std::move(logFile));
+	}
+
+	std::ranges::sort(logFiles, {}, &TrackedLogFile::lastWriteTime);
+
+	for (TrackedLogFile& logFile : logFiles)
+	{
+		this->track(std::move(logFile));
+	}
+}
+
+void Log::RetentionEnforcer::track(TrackedLogFile&& logFile)
+{
+	totalSize += logFile.size;
+	folderLogFiles[logFile.path.parent_path().string()]++;
+
+	tracked.push_back(std::move(logFile));
+}
+
+void Log::RetentionEnforcer::untrack(std::deque<TrackedLogFile>::iterator it)
+{
+	std::string folder = it->path.parent_path().string();
+
+	totalSize -= it->size;
+
+	tracked.erase(it);
+
+	if (auto folderIt = folderLogFiles.find(folder); folderIt != folderLogFiles.end() && !--folderIt->second)
+	{
+		folderLogFiles.erase(folderIt);
+
+		// Only removes folder without any other files
+		std::error_code errorCode;
+
+		std::filesystem::remove(folder, errorCode);
+	}
+}
+
+void Log::RetentionEnforcer::apply(ChangedLogFile& changedLogFile)
+{
+	// Changed log file is one of the newest, search from back
+	auto it = std::find_if(tracked.rbegin(), tracked.rend(), [&changedLogFile](const TrackedLogFile& logFile) { return logFile.path == changedLogFile.path; });
+
+	switch (changedLogFile.change)
+	{
+	case Change::rotated:
+	{
+		TrackedLogFile logFile{ std::move(changedLogFile.path), 0, std::filesystem::file_time_type::min(), changedLogFile.compressing };
+
+		RetentionEnforcer::measure(logFile);
+
+		this->track(std::move(logFile));
+
+		break;
+	}
+
+	case Change::reopened:
+		if (it != tracked.rend())
+		{
+			this->untrack(std::next(it).base());
+		}
+
+		break;
+
+	case Change::compressed:
+		if (it != tracked.rend())
+		{
+			std::filesystem::file_time_type lastWriteTime = it->lastWriteTime;
+
+			totalSize -= it->size;
+
+			RetentionEnforcer::measure(*it);
+
+			totalSize += it->size;
+			it->lastWriteTime = lastWriteTime;
+			it->compressing = false;
+		}
+
+		break;
+	}
+}
+
+bool Log::RetentionEnforcer::isExceeded() const
+{
+	if (tracked.empty())
+	{
+		return false;
+	}
+
+	if (policy.maxTotalSize && totalSize > policy.maxTotalSize)
+	{
+		return true;
+	}
+
+	if (policy.maxLogFiles && tracked.size() > policy.maxLogFiles)
+	{
+		return true;
+	}
+
+	return policy.maxAge.count() && tracked.front().lastWriteTime + policy.maxAge <= std::filesystem::file_time_type::clock::now();
+}
+
+void Log::RetentionEnforcer::run()
+{
+	std::unique_lock<std::mutex> lock(retentionMutex);
+
+	while (running)
+	{
+		std::deque<ChangedLogFile> changes;
+
+		changes.swap(changed);
+
+		lock.unlock();
+
+		// Tracked log files are only accessed from this thread
+		for (ChangedLogFile& changedLogFile : changes)
+		{
+			this->apply(changedLogFile);
+		}
+
+		// Newer log files wait for compression too, continue after compressed
+		while (this->isExceeded() && !tracked.front().compressing)
+		{
+			RetentionEnforcer::removeFiles(tracked.front().path);
+
+			this->untrack(tracked.begin());
+		}
+
+		lock.lock();
+
+		auto hasWork = [this]() { return changed.size() || !running; };
+
+		if (policy.maxAge.count() && tracked.size() && !tracked.front().compressing)
+		{
+			retentionCondition.wait_until(lock, tracked.front().lastWriteTime + policy.maxAge, hasWork);
+		}
+		else
+		{
+			retentionCondition.wait(lock, hasWork);
+		}
+	}
+}
+
+void Log::RetentionEnforcer::notify(const std::filesystem::path& logFilePath, Change change, bool compressing)
+{
+	{
+		std::unique_lock<std::mutex> lock(retentionMutex);
+
+		changed.push_back(ChangedLogFile{ logFilePath, change, compressing });
+	}
+
+	retentionCondition.notify_all();
+}
+
+Log::RetentionEnforcer::RetentionEnforcer(const std::filesystem::path& basePath, const RetentionPolicy& policy) :
+	policy(policy),
+	basePath(basePath),
+	totalSize(0),
+	running(true)
+{
+	this->index();
+
+	retentionThread = std::thread(&RetentionEnforcer::run, this);
+}
+
+void Log::RetentionEnforcer::rotated(const std::filesystem::path& logFilePath, bool compressing)
+{
+	this->notify(logFilePath, Change::rotated, compressing);
+}
+
+void Log::RetentionEnforcer::reopened(const std::filesystem::path& logFilePath)
+{
+	this->notify(logFilePath, Change::reopened);
+}
+
+void Log::RetentionEnforcer::compressed(const std::filesystem::path& logFilePath)
+{
+	this->notify(logFilePath, Change::compressed);
+}
+
+Log::RetentionEnforcer::~RetentionEnforcer()
+{
+	{
+		std::unique_lock<std::mutex> lock(retentionMutex);
+
+		running = false;
+	}
+
+	retentionCondition.notify_all();
+
+	retentionThread.join();
+}
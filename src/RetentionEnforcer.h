@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Log.h"
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <unordered_map>
+
+/**
+ * @brief Background thread that removes oldest log files when RetentionPolicy limits are exceeded
+ */
+class Log::RetentionEnforcer
+{
+private:
+	/**
+	 * @brief Files that belong to log file: log file itself, compressed log file, its index and unfinished compression
+	 */
+	static inline constexpr std::array<std::string_view, 7> suffixes = { "", ".gz", ".gz.index", ".gz.tmp", ".zst", ".zst.index", ".zst.tmp" };
+
+private:
+	/**
+	 * @brief What happened with log file since last pass
+	 */
+	enum class Change
+	{
+		rotated, /// Log file was closed and must be tracked
+		reopened, /// Log file is current log file again and must not be removed
+		compressed /// SegmentCompressor finished with log file, it may be replaced by compressed log file and index. Age stays the same
+	};
+
+	/**
+	 * @brief Log file with its compressed variants measured as one entry
+	 */
+	struct TrackedLogFile
+	{
+		std::filesystem::path path;
+		uintmax_t size;
+		std::filesystem::file_time_type lastWriteTime; /// Of log file itself, or of compressed log file that keeps it
+		bool compressing; /// Waits for SegmentCompressor and must not be removed
+	};
+
+	struct ChangedLogFile
+	{
+		std::filesystem::path path;
+		Change change;
+		bool compressing;
+	};
+
+private:
+	RetentionPolicy policy;
+	std::filesystem::path basePath;
+	std::mutex retentionMutex;
+	std::condition_variable retentionCondition;
+	std::deque<ChangedLogFile> changed;
+	std::deque<TrackedLogFile> tracked;
+	std::unordered_map<std::string, size_t> folderLogFiles;
+	uintmax_t totalSize;
+	bool running;
+	std::thread retentionThread;
+
+private:
+	static std::filesystem::path getLogFilePath(const std::filesystem::path& path);
+
+	static void measure(TrackedLogFile& logFile);
+
+	static void removeFiles(const std::filesystem::path& logFilePath);
+
+	void index();
+
+	void track(TrackedLogFile&& logFile);
+
+	void untrack(std::deque<TrackedLogFile>::iterator it);
+
+	void apply(ChangedLogFile& changedLogFile);
+
+	bool isExceeded() const;
+
+	void run();
+
+	void notify(const std::filesystem::path& logFilePath, Change change, bool compressing = false);
+
+public:
+	/**
+	 * @brief Indexes existing log files in basePath once, then tracks changes reported by Log
+	 */
+	RetentionEnforcer(const std::filesystem::path& basePath, const RetentionPolicy& policy);
+
+	/**
+	 * @brief Log file is closed and may be removed
+	 * @param compressing Log file is requested from SegmentCompressor and is kept until compressed is called
+	 */
+	void rotated(const std::filesystem::path& logFilePath, bool compressing);
+
+	/**
+	 * @brief Log file is resumed as current log file
+	 */
+	void reopened(const std::filesystem::path& logFilePath);
+
+	/**
+	 * @brief SegmentCompressor finished with log file
+	 */
+	void compressed(const std::filesystem::path& logFilePath);
+
+	~RetentionEnforcer();
+};
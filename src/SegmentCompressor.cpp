@@ -0,0 +1,270 @@
+#include "SegmentCompressor.h"
+#include "RetentionEnforcer.h"
+
+#ifdef LOG_ZSTD
+#include <zstd.h>
+#elif defined(LOG_ZLIB)
+#include <zlib.h>
+#endif
+
+#ifdef __LINUX__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+void Log::SegmentCompressor::lowerPriority()
+{
+#ifdef __LINUX__
+	static constexpr int ioPriorityClassIdle = 3;
+	static constexpr int ioPriorityClassShift = 13;
+	static constexpr int ioPriorityWhoProcess = 1;
+
+	// On Linux nice value and I/O priority of thread are set by its id
+	pid_t threadId = static_cast<pid_t>(syscall(SYS_gettid));
+
+	setpriority(PRIO_PROCESS, static_cast<id_t>(threadId), 19);
+
+#ifdef SYS_ioprio_set
+	syscall(SYS_ioprio_set, ioPriorityWhoProcess, threadId, ioPriorityClassIdle << ioPriorityClassShift);
+#endif
+#else
+	SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#endif
+}
+
+bool Log::SegmentCompressor::compressFrame(std::string_view source, std::string& destination)
+{
+#ifdef LOG_ZSTD
+	destination.resize(ZSTD_compressBound(source.size()));
+
+	size_t size = ZSTD_compress(destination.data(), destination.size(), source.data(), source.size(), ZSTD_CLEVEL_DEFAULT);
+
+	if (ZSTD_isError(size))
+	{
+		return false;
+	}
+
+	destination.resize(size);
+
+	return true;
+#elif defined(LOG_ZLIB)
+	static constexpr int gzipWindowBits = 15 + 16;
+
+	z_stream stream = {};
+
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzipWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		return false;
+	}
+
+	destination.resize(deflateBound(&stream, static_cast<uLong>(source.size())));
+
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(source.data()));
+	stream.avail_in = static_cast<uInt>(source.size());
+	stream.next_out = reinterpret_cast<Bytef*>(destination.data());
+	stream.avail_out = static_cast<uInt>(destination.size());
+
+	int result = deflate(&stream, Z_FINISH);
+
+	destination.resize(stream.total_out);
+
+	deflateEnd(&stream);
+
+	return result == Z_STREAM_END;
+#else
+	return false;
+#endif
+}
+
+void Log::SegmentCompressor::run()
+{
+	SegmentCompressor::lowerPriority();
+
+	std::unique_lock<std::mutex> lock(compressorMutex);
+
+	while (true)
+	{
+		compressorCondition.wait(lock, [this]() { return requested.size() || !running; });
+
+		// Shutdown doesn't wait for queued log files, they stay uncompressed
+		if (!running)
+		{
+			break;
+		}
+
+		std::filesystem::path logFilePath = std::move(requested.front());
+
+		requested.pop_front();
+
+		lock.unlock();
+
+		if (this->compress(logFilePath) && log.retentionEnforcer)
+		{
+			log.retentionEnforcer->compressed(logFilePath);
+		}
+
+		lock.lock();
+	}
+}
+
+bool Log::SegmentCompressor::compress(const std::filesystem::path& logFilePath)
+{
+	std::filesystem::path compressedPath = std::filesystem::path(logFilePath) += SegmentCompressor::getExtension();
+	std::filesystem::path temporaryPath = std::filesystem::path(compressedPath) += ".tmp";
+	std::filesystem::path indexPath = std::filesystem::path(compressedPath) += ".index";
+	std::ifstream input(logFilePath, std::ios::binary);
+
+	if (!input.is_open())
+	{
+		std::cerr << "Can't open " << logFilePath.string() << std::endl;
+
+		return false;
+	}
+
+	std::ofstream output(temporaryPath, std::ios::binary);
+	std::ofstream index(indexPath);
+	std::string source(frameSize, '\0');
+	std::string frame;
+	std::string carry;
+	uint64_t uncompressedOffset = 0;
+	uint64_t compressedOffset = 0;
+	bool compressed = output.is_open() && index.is_open();
+
+	index << "# uncompressed offset, compressed offset, compressed size of each frame" << std::endl;
+
+	while (compressed && (input || carry.size()))
+	{
+		source.resize(frameSize);
+
+		std::memcpy(source.data(), carry.data(), carry.size());
+
+		input.read(source.data() + carry.size(), frameSize - carry.size());
+
+		source.resize(carry.size() + static_cast<size_t>(input.gcount()));
+
+		carry.clear();
+
+		if (source.empty())
+		{
+			break;
+		}
+
+		// Frames end on line break when possible so each frame starts with whole record
+		if (input)
+		{
+			if (size_t lineEnd = source.rfind('\n'); lineEnd != std::string::npos)
+			{
+				carry.assign(source, lineEnd + 1);
+
+				source.resize(lineEnd + 1);
+			}
+		}
+
+		if (!SegmentCompressor::compressFrame(source, frame))
+		{
+			compressed = false;
+
+			break;
+		}
+
+		output.write(frame.data(), frame.size());
+
+		index << uncompressedOffset << ' ' << compressedOffset << ' ' << frame.size() << '\n';
+
+		uncompressedOffset += source.size();
+		compressedOffset += frame.size();
+
+		// Full disk fails writes, keep original log file instead of truncated compressed one
+		compressed = output.good() && index.good();
+	}
+
+	output.close();
+	index.close();
+
+	compressed = compressed && !input.bad() && output.good() && index.good();
+
+	input.close();
+
+	std::error_code errorCode;
+
+	if (!compressed)
+	{
+		std::cerr << "Can't compress " << logFilePath.string() << std::endl;
+	}
+	else if (std::filesystem::rename(temporaryPath, compressedPath, errorCode); errorCode)
+	{
+		std::cerr << "Can't rename " << temporaryPath.string() << ": " << errorCode.message() << std::endl;
+
+		compressed = false;
+	}
+
+	if (!compressed)
+	{
+		std::filesystem::remove(temporaryPath, errorCode);
+		std::filesystem::remove(indexPath, errorCode);
+
+		return false;
+	}
+
+	// Compressed log file ages from last record, RetentionEnforcer reads it after restart
+	if (std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(logFilePath, errorCode); !errorCode)
+	{
+		std::filesystem::last_write_time(compressedPath, lastWriteTime, errorCode);
+	}
+
+	std::filesystem::remove(logFilePath, errorCode);
+
+	return true;
+}
+
+bool Log::SegmentCompressor::isAvailable()
+{
+#if defined(LOG_ZSTD) || defined(LOG_ZLIB)
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::string_view Log::SegmentCompressor::getExtension()
+{
+#ifdef LOG_ZSTD
+	return ".zst";
+#else
+	return ".gz";
+#endif
+}
+
+Log::SegmentCompressor::SegmentCompressor(const Log& log) :
+	log(log),
+	running(true)
+{
+	compressorThread = std::thread(&SegmentCompressor::run, this);
+}
+
+void Log::SegmentCompressor::request(const std::filesystem::path& logFilePath)
+{
+	{
+		std::unique_lock<std::mutex> lock(compressorMutex);
+
+		requested.push_back(logFilePath);
+	}
+
+	compressorCondition.notify_all();
+}
+
+Log::SegmentCompressor::~SegmentCompressor()
+{
+	{
+		std::unique_lock<std::mutex> lock(compressorMutex);
+
+		running = false;
+	}
+
+	compressorCondition.notify_all();
+
+	compressorThread.join();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Low priority background thread that compresses rotated log files into independently readable frames
+ */
+class Log::SegmentCompressor
+{
+private:
+	static inline constexpr size_t frameSize = 1024 * 1024;
+
+private:
+	const Log& log;
+	std::mutex compressorMutex;
+	std::condition_variable compressorCondition;
+	std::deque<std::filesystem::path> requested;
+	bool running;
+	std::thread compressorThread;
+
+private:
+	static void lowerPriority();
+
+	static bool compressFrame(std::string_view source, std::string& destination);
+
+	void run();
+
+	/**
+	 * @brief Original log file is kept when compressed file or its index can't be written
+	 * @return true when log file was replaced by compressed file
+	 */
+	bool compress(const std::filesystem::path& logFilePath);
+
+public:
+	/**
+	 * @brief Compression is available if zstd or zlib was found at configure time
+	 */
+	static bool isAvailable();
+
+	/**
+	 * @brief Extension of compressed log files
+	 */
+	static std::string_view getExtension();
+
+public:
+	/**
+	 * @param log Owner of log files, notifies its RetentionEnforcer about compressed log files
+	 */
+	SegmentCompressor(const Log& log);
+
+	/**
+	 * @brief Compress closed log file. Log file is removed after compressed file and its index are written
+	 */
+	void request(const std::filesystem::path& logFilePath);
+
+	/**
+	 * @brief Finishes log file that is being compressed. Other requested log files stay uncompressed
+	 */
+	~SegmentCompressor();
+};
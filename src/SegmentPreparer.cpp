@@ -0,0 +1,201 @@
+#include "SegmentPreparer.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+void Log::SegmentPreparer::run()
+{
+	std::unique_lock<std::mutex> lock(preparerMutex);
+
+	while (true)
+	{
+		preparerCondition.wait(lock, [this]() { return requested || retiredLogFiles.size() || !running; });
+
+		if (!running && retiredLogFiles.empty())
+		{
+			break;
+		}
+
+		std::vector<RetiredLogFile> retired = std::move(retiredLogFiles);
+		bool prepareRequested = requested && running;
+		std::string currentDate = requestedDate;
+		std::ofstream stream;
+		std::filesystem::path path;
+
+		retiredLogFiles.clear();
+
+		requested = false;
+		preparing = prepareRequested;
+
+		lock.unlock();
+
+		for (RetiredLogFile& logFile : retired)
+		{
+			this->close(logFile);
+		}
+
+		if (prepareRequested)
+		{
+			this->prepare(currentDate, stream, path);
+		}
+
+		lock.lock();
+
+		if (prepareRequested)
+		{
+			preparedLogFile = std::move(stream);
+			preparedLogFilePath = std::move(path);
+			preparedDate = std::move(currentDate);
+			prepared = preparedLogFile.is_open();
+			preparing = false;
+
+			preparerCondition.notify_all();
+		}
+	}
+}
+
+void Log::SegmentPreparer::prepare(const std::string& currentDate, std::ofstream& stream, std::filesystem::path& path)
+{
+	try
+	{
+		path = log.newLogFilePath(currentDate);
+
+		stream.open(path, std::ios::app | log.getLogFileOpenMode());
+
+#ifdef __LINUX__
+		if (preallocateSize && stream.is_open())
+		{
+			if (int descriptor = ::open(path.c_str(), O_WRONLY); descriptor != -1)
+			{
+				fallocate(descriptor, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(preallocateSize));
+
+				::close(descriptor);
+			}
+		}
+#endif
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Can't prepare next log file: " << e.what() << std::endl;
+
+		stream.close();
+	}
+}
+
+void Log::SegmentPreparer::close(RetiredLogFile& logFile)
+{
+	logFile.stream.close();
+
+	std::error_code errorCode;
+
+	if (logFile.remove)
+	{
+		std::filesystem::remove(logFile.path, errorCode);
+	}
+	else if (preallocateSize)
+	{
+		// Release blocks reserved after end of file
+		std::filesystem::resize_file(logFile.path, std::filesystem::file_size(logFile.path, errorCode), errorCode);
+	}
+}
+
+void Log::SegmentPreparer::discardPrepared()
+{
+	if (!prepared)
+	{
+		return;
+	}
+
+	retiredLogFiles.push_back(RetiredLogFile{ std::move(preparedLogFile), std::move(preparedLogFilePath), true });
+
+	prepared = false;
+}
+
+Log::SegmentPreparer::SegmentPreparer(const Log& log, uintmax_t preallocateSize) :
+	log(log),
+	preallocateSize(preallocateSize),
+	requested(false),
+	preparing(false),
+	prepared(false),
+	running(true)
+{
+	preparerThread = std::thread(&SegmentPreparer::run, this);
+}
+
+void Log::SegmentPreparer::request(const std::string& currentDate)
+{
+	{
+		std::unique_lock<std::mutex> lock(preparerMutex);
+
+		if (prepared && preparedDate == currentDate)
+		{
+			return;
+		}
+
+		this->discardPrepared();
+
+		requested = true;
+		requestedDate = currentDate;
+	}
+
+	preparerCondition.notify_all();
+}
+
+bool Log::SegmentPreparer::tryTake(const std::string& currentDate, std::ofstream& logFile, std::filesystem::path& logFilePath)
+{
+	{
+		std::unique_lock<std::mutex> lock(preparerMutex);
+
+		preparerCondition.wait(lock, [this]() { return !requested && !preparing; });
+
+		// Background thread wakes once to close old log file and prepare next one, second lock would wait for it
+		requested = true;
+		requestedDate = currentDate;
+
+		if (!prepared || preparedDate != currentDate)
+		{
+			this->discardPrepared();
+
+			lock.unlock();
+
+			preparerCondition.notify_all();
+
+			return false;
+		}
+
+		logFile.swap(preparedLogFile);
+		logFilePath.swap(preparedLogFilePath);
+
+		retiredLogFiles.push_back(RetiredLogFile{ std::move(preparedLogFile), std::move(preparedLogFilePath), false });
+
+		prepared = false;
+	}
+
+	preparerCondition.notify_all();
+
+	return true;
+}
+
+Log::SegmentPreparer::~SegmentPreparer()
+{
+	{
+		std::unique_lock<std::mutex> lock(preparerMutex);
+
+		this->discardPrepared();
+
+		running = false;
+	}
+
+	preparerCondition.notify_all();
+
+	preparerThread.join();
+
+	this->discardPrepared();
+
+	for (RetiredLogFile& logFile : retiredLogFiles)
+	{
+		this->close(logFile);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+
+/**
+ * @brief Background thread that creates and opens next log file ahead of rotation and closes retired log files
+ */
+class Log::SegmentPreparer
+{
+private:
+	struct RetiredLogFile
+	{
+		std::ofstream stream;
+		std::filesystem::path path;
+		bool remove;
+	};
+
+private:
+	const Log& log;
+	uintmax_t preallocateSize;
+	std::mutex preparerMutex;
+	std::condition_variable preparerCondition;
+	std::string requestedDate;
+	std::string preparedDate;
+	std::ofstream preparedLogFile;
+	std::filesystem::path preparedLogFilePath;
+	std::vector<RetiredLogFile> retiredLogFiles;
+	bool requested;
+	bool preparing;
+	bool prepared;
+	bool running;
+	std::thread preparerThread;
+
+private:
+	void run();
+
+	void prepare(const std::string& currentDate, std::ofstream& stream, std::filesystem::path& path);
+
+	void close(RetiredLogFile& logFile);
+
+	void discardPrepared();
+
+public:
+	/**
+	 * @param log Owner of log files
+	 * @param preallocateSize Bytes reserved on disk for each prepared log file. 0 for no preallocation
+	 */
+	SegmentPreparer(const Log& log, uintmax_t preallocateSize);
+
+	/**
+	 * @brief Prepare log file for currentDate unless one is already prepared
+	 */
+	void request(const std::string& currentDate);
+
+	/**
+	 * @brief Swap logFile with prepared log file for currentDate and request next one. Old log file is closed on background thread
+	 * @return false if there is no prepared log file for currentDate
+	 */
+	bool tryTake(const std::string& currentDate, std::ofstream& logFile, std::filesystem::path& logFilePath);
+
+	~SegmentPreparer();
+};
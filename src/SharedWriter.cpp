@@ -0,0 +1,88 @@
+#include "SharedWriter.h"
+
+#include <algorithm>
+
+std::mutex Log::SharedWriter::instanceMutex;
+std::weak_ptr<Log::SharedWriter> Log::SharedWriter::instance;
+
+void Log::SharedWriter::run()
+{
+	while (true)
+	{
+		size_t observedCount = wakeCounter.load(std::memory_order_acquire);
+		bool isRunning = running.load(std::memory_order_acquire);
+		bool consumed = false;
+
+		{
+			std::unique_lock<std::mutex> lock(writerMutex);
+
+			for (Log* log : logs)
+			{
+				consumed |= log->consumeRecords(maxBatchRecords);
+			}
+		}
+
+		if (consumed)
+		{
+			continue;
+		}
+
+		if (!isRunning)
+		{
+			break;
+		}
+
+		wakeCounter.wait(observedCount, std::memory_order_acquire);
+	}
+}
+
+std::shared_ptr<Log::SharedWriter> Log::SharedWriter::get()
+{
+	std::unique_lock<std::mutex> lock(instanceMutex);
+	std::shared_ptr<SharedWriter> result = instance.lock();
+
+	if (!result)
+	{
+		result = std::make_shared<SharedWriter>();
+
+		instance = result;
+	}
+
+	return result;
+}
+
+Log::SharedWriter::SharedWriter() :
+	wakeCounter(0),
+	running(true)
+{
+	writerThread = std::thread(&SharedWriter::run, this);
+}
+
+std::atomic<size_t>& Log::SharedWriter::getWakeCounter()
+{
+	return wakeCounter;
+}
+
+void Log::SharedWriter::add(Log& log)
+{
+	std::unique_lock<std::mutex> lock(writerMutex);
+
+	logs.push_back(&log);
+}
+
+void Log::SharedWriter::remove(Log& log)
+{
+	std::unique_lock<std::mutex> lock(writerMutex);
+
+	logs.erase(std::ranges::find(logs, &log));
+}
+
+Log::SharedWriter::~SharedWriter()
+{
+	running = false;
+
+	wakeCounter.fetch_add(1, std::memory_order_release);
+	wakeCounter.notify_all();
+
+	writerThread.join();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Log.h"
+
+/**
+ * @brief Background thread that writes queued records of all asynchronous loggers. Started with first asynchronous logger and stopped after last one
+ */
+class Log::SharedWriter
+{
+private:
+	static inline constexpr size_t cacheLineSize = 64;
+
+	/**
+	 * @brief Records written for one logger before next logger gets its turn
+	 */
+	static inline constexpr size_t maxBatchRecords = 4096;
+
+	static std::mutex instanceMutex;
+	static std::weak_ptr<SharedWriter> instance;
+
+private:
+	std::mutex writerMutex;
+	std::vector<Log*> logs;
+	alignas(cacheLineSize) std::atomic<size_t> wakeCounter;
+	std::atomic<bool> running;
+	std::thread writerThread;
+
+private:
+	void run();
+
+public:
+	/**
+	 * @brief Get running writer or start new one
+	 */
+	static std::shared_ptr<SharedWriter> get();
+
+public:
+	SharedWriter();
+
+	/**
+	 * @brief Counter for RecordQueue of each logger, push wakes writer
+	 */
+	std::atomic<size_t>& getWakeCounter();
+
+	void add(Log& log);
+
+	/**
+	 * @brief Writer doesn't touch log after return. Records left in queue are consumed by caller
+	 */
+	void remove(Log& log);
+
+	~SharedWriter();
+};
@@ -0,0 +1,118 @@
+#include "Log.h"
+
+Log::Sink::Sink(VerbosityLevel level, size_t capacity) :
+	level(level),
+	capacity(capacity),
+	droppedCount(0)
+{
+
+}
+
+Log::VerbosityLevel Log::Sink::getLevel() const
+{
+	return level;
+}
+
+size_t Log::Sink::getCapacity() const
+{
+	return capacity;
+}
+
+uint64_t Log::Sink::getDroppedCount() const
+{
+	return droppedCount.load(std::memory_order_relaxed);
+}
+
+void Log::Sink::flush()
+{
+
+}
+
+Log::StreamSink::StreamSink(std::ostream& stream, VerbosityLevel level, size_t capacity) :
+	Sink(level, capacity),
+	stream(stream)
+{
+
+}
+
+void Log::StreamSink::write(const std::shared_ptr<const std::string>& record, VerbosityLevel level)
+{
+	stream << *record << '\n';
+}
+
+void Log::StreamSink::flush()
+{
+	stream.flush();
+}
+
+Log::FileSink::FileSink(const std::filesystem::path& path, VerbosityLevel level, size_t capacity) :
+	Sink(level, capacity),
+	file(path, std::ios::app)
+{
+	if (!file.is_open())
+	{
+		throw std::runtime_error(std::format("Can't open {}", path.string()));
+	}
+}
+
+void Log::FileSink::write(const std::shared_ptr<const std::string>& record, VerbosityLevel level)
+{
+	file << *record << '\n';
+}
+
+void Log::FileSink::flush()
+{
+	file.flush();
+}
+
+Log::CallbackSink::CallbackSink(const std::function<void(std::string_view, VerbosityLevel)>& callback, VerbosityLevel level, size_t capacity) :
+	Sink(level, capacity),
+	callback(callback)
+{
+
+}
+
+void Log::CallbackSink::write(const std::shared_ptr<const std::string>& record, VerbosityLevel level)
+{
+	callback(*record, level);
+}
+
+Log::RingSink::RingSink(size_t size, VerbosityLevel level, size_t capacity) :
+	Sink(level, capacity),
+	records(size),
+	next(0)
+{
+
+}
+
+void Log::RingSink::write(const std::shared_ptr<const std::string>& record, VerbosityLevel level)
+{
+	if (records.empty())
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(ringMutex);
+
+	records[next] = record;
+
+	next = (next + 1) % records.size();
+}
+
+std::vector<std::shared_ptr<const std::string>> Log::RingSink::getRecords() const
+{
+	std::vector<std::shared_ptr<const std::string>> result;
+	std::unique_lock<std::mutex> lock(ringMutex);
+
+	result.reserve(records.size());
+
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		if (const std::shared_ptr<const std::string>& record = records[(next + i) % records.size()])
+		{
+			result.push_back(record);
+		}
+	}
+
+	return result;
+}
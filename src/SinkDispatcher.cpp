@@ -0,0 +1,242 @@
+#include "SinkDispatcher.h"
+
+#include <algorithm>
+
+Log::SinkDispatcher::DuplicateSink::DuplicateSink() :
+	outputStream(nullptr),
+	errorStream(nullptr)
+{
+
+}
+
+void Log::SinkDispatcher::DuplicateSink::setOutputStream(std::ostream& outputStream)
+{
+	this->outputStream = &outputStream;
+}
+
+void Log::SinkDispatcher::DuplicateSink::setErrorStream(std::ostream& errorStream)
+{
+	this->errorStream = &errorStream;
+}
+
+void Log::SinkDispatcher::DuplicateSink::write(const std::shared_ptr<const std::string>& record, VerbosityLevel level)
+{
+	std::ostream* stream = outputStream;
+
+	if (level == VerbosityLevel::error && errorStream)
+	{
+		stream = errorStream;
+	}
+
+	if (stream)
+	{
+		(*stream) << *record << '\n';
+	}
+}
+
+void Log::SinkDispatcher::DuplicateSink::flush()
+{
+	if (std::ostream* stream = outputStream)
+	{
+		stream->flush();
+	}
+
+	if (std::ostream* stream = errorStream)
+	{
+		stream->flush();
+	}
+}
+
+void Log::SinkDispatcher::run(Channel& channel)
+{
+	std::deque<QueuedRecord> batch;
+	std::unique_lock<std::mutex> lock(channel.channelMutex);
+
+	while (true)
+	{
+		channel.channelCondition.wait(lock, [&channel]() { return channel.records.size() || !channel.running; });
+
+		if (channel.records.empty())
+		{
+			break;
+		}
+
+		batch.swap(channel.records);
+
+		lock.unlock();
+
+		for (const QueuedRecord& record : batch)
+		{
+			channel.sink->write(record.data, record.level);
+		}
+
+		channel.sink->flush();
+
+		lock.lock();
+
+		channel.written += batch.size();
+
+		batch.clear();
+
+		channel.channelCondition.notify_all();
+	}
+}
+
+void Log::SinkDispatcher::stop(Channel& channel)
+{
+	{
+		std::unique_lock<std::mutex> lock(channel.channelMutex);
+
+		channel.running = false;
+	}
+
+	channel.channelCondition.notify_all();
+
+	channel.channelThread.join();
+}
+
+void Log::SinkDispatcher::updateLowestLevel()
+{
+	int level = std::numeric_limits<int>::max();
+
+	for (const std::shared_ptr<Channel>& channel : channels)
+	{
+		level = std::min(level, static_cast<int>(channel->sink->getLevel()));
+	}
+
+	lowestLevel.store(level, std::memory_order_relaxed);
+}
+
+Log::SinkDispatcher::DuplicateSink& Log::SinkDispatcher::getDuplicateSink()
+{
+	if (!duplicateSink)
+	{
+		duplicateSink = std::make_shared<DuplicateSink>();
+
+		this->add(duplicateSink);
+	}
+
+	return *duplicateSink;
+}
+
+Log::SinkDispatcher::SinkDispatcher() :
+	lowestLevel(std::numeric_limits<int>::max())
+{
+
+}
+
+bool Log::SinkDispatcher::accepts(Level type) const
+{
+	return static_cast<int>(type) >= lowestLevel.load(std::memory_order_relaxed);
+}
+
+void Log::SinkDispatcher::dispatch(std::string_view data, Level type)
+{
+	if (!this->accepts(type))
+	{
+		return;
+	}
+
+	VerbosityLevel level = std::min(static_cast<VerbosityLevel>(type), VerbosityLevel::error);
+	std::shared_ptr<const std::string> record = std::make_shared<const std::string>(data);
+
+	for (const std::shared_ptr<Channel>& channel : channels)
+	{
+		Sink& sink = *channel->sink;
+
+		if (level < sink.level)
+		{
+			continue;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(channel->channelMutex);
+
+			if (channel->records.size() >= sink.capacity)
+			{
+				sink.droppedCount.fetch_add(1, std::memory_order_relaxed);
+
+				continue;
+			}
+
+			channel->records.push_back(QueuedRecord{ record, level });
+			channel->pushed++;
+		}
+
+		// Flush may wait on same condition
+		channel->channelCondition.notify_all();
+	}
+}
+
+void Log::SinkDispatcher::add(const std::shared_ptr<Sink>& sink)
+{
+	std::shared_ptr<Channel>& channel = channels.emplace_back(std::make_shared<Channel>());
+
+	channel->sink = sink;
+	channel->channelThread = std::thread(&SinkDispatcher::run, std::ref(*channel));
+
+	this->updateLowestLevel();
+}
+
+bool Log::SinkDispatcher::remove(const std::shared_ptr<Sink>& sink)
+{
+	auto it = std::ranges::find(channels, sink, [](const std::shared_ptr<Channel>& channel) -> const std::shared_ptr<Sink>& { return channel->sink; });
+
+	if (it == channels.end())
+	{
+		return false;
+	}
+
+	SinkDispatcher::stop(**it);
+
+	channels.erase(it);
+
+	this->updateLowestLevel();
+
+	return true;
+}
+
+void Log::SinkDispatcher::setOutputStream(std::ostream& outputStream)
+{
+	this->getDuplicateSink().setOutputStream(outputStream);
+}
+
+void Log::SinkDispatcher::setErrorStream(std::ostream& errorStream)
+{
+	this->getDuplicateSink().setErrorStream(errorStream);
+}
+
+Log::SinkDispatcher::PushedRecords Log::SinkDispatcher::getPushedRecords() const
+{
+	PushedRecords result;
+
+	result.reserve(channels.size());
+
+	for (const std::shared_ptr<Channel>& channel : channels)
+	{
+		std::unique_lock<std::mutex> lock(channel->channelMutex);
+
+		result.emplace_back(channel, channel->pushed);
+	}
+
+	return result;
+}
+
+void Log::SinkDispatcher::flush(const PushedRecords& pushedRecords)
+{
+	// Removed sink wrote all its records before its thread stopped
+	for (const auto& [channel, pushed] : pushedRecords)
+	{
+		std::unique_lock<std::mutex> lock(channel->channelMutex);
+
+		channel->channelCondition.wait(lock, [&channel, pushed]() { return channel->written >= pushed; });
+	}
+}
+
+Log::SinkDispatcher::~SinkDispatcher()
+{
+	for (const std::shared_ptr<Channel>& channel : channels)
+	{
+		SinkDispatcher::stop(*channel);
+	}
+}
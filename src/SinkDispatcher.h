@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+#include <deque>
+
+/**
+ * @brief Fans out text records to sinks. Each sink has own queue and thread
+ */
+class Log::SinkDispatcher
+{
+private:
+	struct QueuedRecord
+	{
+		std::shared_ptr<const std::string> data;
+		VerbosityLevel level;
+	};
+
+	/**
+	 * @brief Sink with its queue and thread
+	 */
+	struct Channel
+	{
+		std::shared_ptr<Sink> sink;
+		std::mutex channelMutex;
+		std::condition_variable channelCondition;
+		std::deque<QueuedRecord> records;
+		uint64_t pushed = 0;
+		uint64_t written = 0;
+		bool running = true;
+		std::thread channelThread;
+	};
+
+	/**
+	 * @brief Sink for Log::duplicateLog and Log::duplicateErrorLog. Errors go to error stream if it is set
+	 */
+	class DuplicateSink : public Sink
+	{
+	private:
+		std::atomic<std::ostream*> outputStream;
+		std::atomic<std::ostream*> errorStream;
+
+	public:
+		DuplicateSink();
+
+		void setOutputStream(std::ostream& outputStream);
+
+		void setErrorStream(std::ostream& errorStream);
+
+		void write(const std::shared_ptr<const std::string>& record, VerbosityLevel level) override;
+
+		void flush() override;
+
+		~DuplicateSink() = default;
+	};
+
+public:
+	/**
+	 * @brief Records pushed to each sink. Shared channel stays valid if sink is removed before flush
+	 */
+	using PushedRecords = std::vector<std::pair<std::shared_ptr<Channel>, uint64_t>>;
+
+private:
+	std::vector<std::shared_ptr<Channel>> channels;
+	std::shared_ptr<DuplicateSink> duplicateSink;
+	std::atomic<int> lowestLevel;
+
+private:
+	static void run(Channel& channel);
+
+	static void stop(Channel& channel);
+
+	void updateLowestLevel();
+
+	DuplicateSink& getDuplicateSink();
+
+public:
+	SinkDispatcher();
+
+	/**
+	 * @brief Any sink accepts records of this level. Doesn't need Log::writeMutex
+	 */
+	bool accepts(Level type) const;
+
+	/**
+	 * @brief Copy record once into shared buffer and push it to each sink that accepts its level. Never waits for sinks
+	 */
+	void dispatch(std::string_view data, Level type);
+
+	void add(const std::shared_ptr<Sink>& sink);
+
+	bool remove(const std::shared_ptr<Sink>& sink);
+
+	void setOutputStream(std::ostream& outputStream);
+
+	void setErrorStream(std::ostream& errorStream);
+
+	/**
+	 * @brief Records dispatched until now. Needs Log::writeMutex, which can be released before flush
+	 */
+	PushedRecords getPushedRecords() const;
+
+	/**
+	 * @brief Wait until sinks wrote and flushed pushed records. Doesn't need Log::writeMutex
+	 */
+	static void flush(const PushedRecords& pushedRecords);
+
+	/**
+	 * @brief Writes all dispatched records before return
+	 */
+	~SinkDispatcher();
+};
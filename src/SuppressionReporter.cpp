@@ -0,0 +1,157 @@
+#include "SuppressionReporter.h"
+
+#include <algorithm>
+
+void Log::SuppressionReporter::run()
+{
+	std::vector<Summary> summaries;
+	std::unique_lock<std::mutex> lock(reporterMutex);
+
+	while (true)
+	{
+		summaries.swap(removed);
+
+		if (!running)
+		{
+			for (PendingSite& pendingSite : sites)
+			{
+				if (uint64_t suppressed = pendingSite.site->takeSuppressed(pendingSite.count, pendingSite.site->state.load(std::memory_order_relaxed) & ~RateLimitSite::recordsMask))
+				{
+					summaries.push_back(Summary{ pendingSite.level, std::move(pendingSite.category), suppressed });
+				}
+			}
+
+			sites.clear();
+
+			lock.unlock();
+
+			this->write(summaries);
+
+			break;
+		}
+
+		int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		int64_t nextCheck = std::numeric_limits<int64_t>::max();
+
+		for (auto it = sites.begin(); it != sites.end();)
+		{
+			uint64_t window = it->site->state.load(std::memory_order_relaxed) & ~RateLimitSite::recordsMask;
+			int64_t period = std::max<int64_t>(it->period.count(), 1);
+
+			// Record of next period reports this one itself
+			if (window == RateLimitSite::getWindow(it->period))
+			{
+				nextCheck = std::min(nextCheck, (now / period + 1) * period);
+
+				++it;
+
+				continue;
+			}
+
+			if (uint64_t suppressed = it->site->takeSuppressed(it->count, window))
+			{
+				summaries.push_back(Summary{ it->level, std::move(it->category), suppressed });
+			}
+
+			it = sites.erase(it);
+		}
+
+		if (summaries.size())
+		{
+			lock.unlock();
+
+			this->write(summaries);
+
+			summaries.clear();
+
+			lock.lock();
+
+			continue;
+		}
+
+		if (sites.empty())
+		{
+			reporterCondition.wait(lock, [this]() { return removed.size() || !running; });
+		}
+		else
+		{
+			reporterCondition.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(nextCheck)), [this]() { return removed.size() || !running; });
+		}
+	}
+}
+
+void Log::SuppressionReporter::write(const std::vector<Summary>& summaries)
+{
+	for (const Summary& summary : summaries)
+	{
+		log.writeSuppressedSummary(summary.level, summary.category, summary.suppressed);
+	}
+}
+
+Log::SuppressionReporter::SuppressionReporter(Log& log) :
+	log(log),
+	running(true)
+{
+
+}
+
+void Log::SuppressionReporter::add(RateLimitSite& site, Level level, std::string_view category, uint32_t count, std::chrono::nanoseconds period)
+{
+	{
+		std::unique_lock<std::mutex> lock(reporterMutex);
+
+		if (std::ranges::find(sites, &site, &PendingSite::site) != sites.end())
+		{
+			return;
+		}
+
+		sites.push_back(PendingSite{ &site, level, std::string(category), count, period });
+
+		if (!reporterThread.joinable())
+		{
+			reporterThread = std::thread(&SuppressionReporter::run, this);
+		}
+	}
+
+	reporterCondition.notify_all();
+}
+
+void Log::SuppressionReporter::remove(RateLimitSite& site)
+{
+	{
+		std::unique_lock<std::mutex> lock(reporterMutex);
+
+		auto it = std::ranges::find(sites, &site, &PendingSite::site);
+
+		if (it == sites.end())
+		{
+			return;
+		}
+
+		// Destroyed call site doesn't start other period
+		if (uint64_t suppressed = site.takeSuppressed(it->count, site.state.load(std::memory_order_relaxed) & ~RateLimitSite::recordsMask))
+		{
+			removed.push_back(Summary{ it->level, std::move(it->category), suppressed });
+		}
+
+		sites.erase(it);
+	}
+
+	reporterCondition.notify_all();
+}
+
+Log::SuppressionReporter::~SuppressionReporter()
+{
+	{
+		std::unique_lock<std::mutex> lock(reporterMutex);
+
+		running = false;
+	}
+
+	reporterCondition.notify_all();
+
+	if (reporterThread.joinable())
+	{
+		reporterThread.join();
+	}
+}
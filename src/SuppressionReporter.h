@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Log.h"
+
+#include <condition_variable>
+
+/**
+ * @brief Writes summary of suppressed records when period of rate limited call site ends without next record starting new period. Thread starts with first suppressed record
+ */
+class Log::SuppressionReporter
+{
+private:
+	struct PendingSite
+	{
+		RateLimitSite* site;
+		Level level;
+		std::string category;
+		uint32_t count;
+		std::chrono::nanoseconds period;
+	};
+
+	struct Summary
+	{
+		Level level;
+		std::string category;
+		uint64_t suppressed;
+	};
+
+private:
+	Log& log;
+	std::mutex reporterMutex;
+	std::condition_variable reporterCondition;
+	std::vector<PendingSite> sites;
+	std::vector<Summary> removed; /// Summaries of destroyed call sites
+	bool running;
+	std::thread reporterThread;
+
+private:
+	void run();
+
+	void write(const std::vector<Summary>& summaries);
+
+public:
+	SuppressionReporter(Log& log);
+
+	/**
+	 * @brief Call site suppressed its first record in period
+	 */
+	void add(RateLimitSite& site, Level level, std::string_view category, uint32_t count, std::chrono::nanoseconds period);
+
+	/**
+	 * @brief Summary of destroyed call site is written by reporter thread. Static call sites are destroyed at exit, when thread local buffers of caller may be destroyed already
+	 */
+	void remove(RateLimitSite& site);
+
+	/**
+	 * @brief Reporter thread writes summaries of all call sites before it stops
+	 */
+	~SuppressionReporter();
+};
@@ -0,0 +1,356 @@
+#include "UringFileWriter.h"
+
+#ifdef LOG_URING
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static constexpr unsigned ringEntries = 8;
+
+void Log::UringFileWriter::submit(Buffer& buffer)
+{
+	if (!buffer.size)
+	{
+		return;
+	}
+
+	unsigned tail = *submissionTail;
+	unsigned index = tail & *submissionMask;
+	io_uring_sqe& entry = submissionEntries[index];
+
+	std::memset(&entry, 0, sizeof(entry));
+
+	entry.opcode = IORING_OP_WRITE;
+	entry.fd = descriptor;
+	entry.addr = reinterpret_cast<uint64_t>(buffer.data);
+	entry.len = static_cast<uint32_t>(buffer.size);
+	entry.off = fileOffset;
+	entry.user_data = static_cast<uint64_t>(&buffer - buffers.data());
+
+	submissionArray[index] = index;
+
+	std::atomic_ref<unsigned>(*submissionTail).store(tail + 1, std::memory_order_release);
+
+	buffer.offset = fileOffset;
+	buffer.inFlight = true;
+
+	fileOffset += buffer.size;
+
+	while (syscall(__NR_io_uring_enter, ringDescriptor, 1, 0, 0, nullptr, 0) < 0 && errno == EINTR);
+}
+
+void Log::UringFileWriter::reap(unsigned minimum)
+{
+	if (minimum)
+	{
+		while (syscall(__NR_io_uring_enter, ringDescriptor, 0, minimum, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno == EINTR);
+	}
+
+	unsigned head = *completionHead;
+	unsigned tail = std::atomic_ref<unsigned>(*completionTail).load(std::memory_order_acquire);
+
+	for (; head != tail; head++)
+	{
+		const io_uring_cqe& entry = completionEntries[head & *completionMask];
+		Buffer& buffer = buffers[entry.user_data];
+		size_t written = entry.res < 0 ? 0 : static_cast<size_t>(entry.res);
+
+		// Failed or short write, rest of buffer is written directly so records aren't lost
+		if (written < buffer.size)
+		{
+			this->writeSynchronously(buffer.data + written, buffer.size - written, buffer.offset + written);
+		}
+
+		buffer.size = 0;
+		buffer.inFlight = false;
+	}
+
+	std::atomic_ref<unsigned>(*completionHead).store(head, std::memory_order_release);
+}
+
+void Log::UringFileWriter::waitBuffer(Buffer& buffer)
+{
+	this->reap(0);
+
+	while (buffer.inFlight)
+	{
+		this->reap(1);
+	}
+}
+
+void Log::UringFileWriter::writeSynchronously(const char* data, size_t size, uint64_t offset)
+{
+	while (size)
+	{
+		ssize_t written = pwrite(descriptor, data, size, static_cast<off_t>(offset));
+
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			std::cerr << "Can't write log file: " << std::strerror(errno) << std::endl;
+
+			return;
+		}
+
+		data += written;
+		size -= written;
+		offset += written;
+	}
+}
+
+void Log::UringFileWriter::release()
+{
+	for (Buffer& buffer : buffers)
+	{
+		::operator delete[](buffer.data, std::align_val_t(bufferAlignment));
+	}
+
+	if (submissionEntries)
+	{
+		munmap(submissionEntries, submissionEntriesSize);
+	}
+
+	if (completionRing && completionRing != submissionRing)
+	{
+		munmap(completionRing, completionRingSize);
+	}
+
+	if (submissionRing)
+	{
+		munmap(submissionRing, submissionRingSize);
+	}
+
+	if (ringDescriptor != -1)
+	{
+		::close(ringDescriptor);
+	}
+}
+
+Log::UringFileWriter::UringFileWriter(size_t capacity) :
+	ringDescriptor(-1),
+	submissionRing(nullptr),
+	submissionRingSize(0),
+	completionRing(nullptr),
+	completionRingSize(0),
+	submissionEntries(nullptr),
+	submissionEntriesSize(0),
+	buffers(),
+	capacity((std::max<size_t>(capacity, 1) + bufferAlignment - 1) / bufferAlignment * bufferAlignment),
+	current(0),
+	fileOffset(0),
+	descriptor(-1)
+{
+	io_uring_params parameters = {};
+
+	ringDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, ringEntries, &parameters));
+
+	if (ringDescriptor == -1)
+	{
+		throw std::runtime_error(std::format("io_uring is not available: {}", std::strerror(errno)));
+	}
+
+	// Kernels before 5.6 create ring without write operation, probe fails there too
+	std::vector<uint64_t> probeStorage((sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+
+	if (syscall(__NR_io_uring_register, ringDescriptor, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+		probe->last_op < IORING_OP_WRITE ||
+		!(probe->ops[IORING_OP_WRITE].flags & IO_URING_OP_SUPPORTED))
+	{
+		this->release();
+
+		throw std::runtime_error("io_uring doesn't support write operation");
+	}
+
+	submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+	completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+	submissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+
+	if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		submissionRingSize = completionRingSize = std::max(submissionRingSize, completionRingSize);
+	}
+
+	submissionRing = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING);
+	completionRing = (parameters.features & IORING_FEAT_SINGLE_MMAP) ?
+		submissionRing :
+		mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_CQ_RING);
+	void* entries = mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES);
+
+	if (submissionRing == MAP_FAILED || completionRing == MAP_FAILED || entries == MAP_FAILED)
+	{
+		int error = errno;
+
+		submissionRing = submissionRing == MAP_FAILED ? nullptr : submissionRing;
+		completionRing = completionRing == MAP_FAILED ? nullptr : completionRing;
+		submissionEntries = entries == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(entries);
+
+		this->release();
+
+		throw std::runtime_error(std::format("Can't map io_uring: {}", std::strerror(error)));
+	}
+
+	char* submission = static_cast<char*>(submissionRing);
+	char* completion = static_cast<char*>(completionRing);
+
+	submissionEntries = static_cast<io_uring_sqe*>(entries);
+	submissionTail = reinterpret_cast<unsigned*>(submission + parameters.sq_off.tail);
+	submissionMask = reinterpret_cast<unsigned*>(submission + parameters.sq_off.ring_mask);
+	submissionArray = reinterpret_cast<unsigned*>(submission + parameters.sq_off.array);
+	completionHead = reinterpret_cast<unsigned*>(completion + parameters.cq_off.head);
+	completionTail = reinterpret_cast<unsigned*>(completion + parameters.cq_off.tail);
+	completionMask = reinterpret_cast<unsigned*>(completion + parameters.cq_off.ring_mask);
+	completionEntries = reinterpret_cast<io_uring_cqe*>(completion + parameters.cq_off.cqes);
+
+	for (Buffer& buffer : buffers)
+	{
+		buffer.data = new (std::align_val_t(bufferAlignment)) char[this->capacity];
+		buffer.size = 0;
+		buffer.offset = 0;
+		buffer.inFlight = false;
+	}
+}
+
+void Log::UringFileWriter::open(const std::filesystem::path& logFilePath)
+{
+	this->flush();
+
+	if (descriptor != -1)
+	{
+		::close(descriptor);
+	}
+
+	descriptor = ::open(logFilePath.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+
+	if (descriptor == -1)
+	{
+		throw std::runtime_error(std::format("Can't open {}: {}", logFilePath.string(), std::strerror(errno)));
+	}
+
+	fileOffset = static_cast<uint64_t>(lseek(descriptor, 0, SEEK_END));
+}
+
+void Log::UringFileWriter::append(std::string_view data)
+{
+	size_t size = data.size() + 1;
+
+	if (buffers[current].size + size > capacity)
+	{
+		this->submit(buffers[current]);
+
+		current = (current + 1) % buffersCount;
+
+		this->waitBuffer(buffers[current]);
+
+		if (size > capacity)
+		{
+			// Record doesn't fit into buffer, its place in file is reserved and it is written directly
+			uint64_t offset = fileOffset;
+
+			fileOffset += size;
+
+			this->writeSynchronously(data.data(), data.size(), offset);
+			this->writeSynchronously("\n", 1, offset + data.size());
+
+			return;
+		}
+	}
+
+	Buffer& buffer = buffers[current];
+
+	std::memcpy(buffer.data + buffer.size, data.data(), data.size());
+
+	buffer.data[buffer.size + data.size()] = '\n';
+
+	buffer.size += size;
+}
+
+void Log::UringFileWriter::flush()
+{
+	for (Buffer& buffer : buffers)
+	{
+		this->waitBuffer(buffer);
+	}
+
+	// Nothing is in flight, one write is cheaper than submission and completion
+	Buffer& buffer = buffers[current];
+
+	this->writeSynchronously(buffer.data, buffer.size, fileOffset);
+
+	fileOffset += buffer.size;
+	buffer.size = 0;
+}
+
+Log::UringFileWriter::~UringFileWriter()
+{
+	this->flush();
+
+	if (descriptor != -1)
+	{
+		::close(descriptor);
+	}
+
+	this->release();
+}
+#else
+void Log::UringFileWriter::submit(Buffer& buffer)
+{
+
+}
+
+void Log::UringFileWriter::reap(unsigned minimum)
+{
+
+}
+
+void Log::UringFileWriter::waitBuffer(Buffer& buffer)
+{
+
+}
+
+void Log::UringFileWriter::writeSynchronously(const char* data, size_t size, uint64_t offset)
+{
+
+}
+
+void Log::UringFileWriter::release()
+{
+
+}
+
+Log::UringFileWriter::UringFileWriter(size_t capacity)
+{
+	throw std::runtime_error("io_uring is not available");
+}
+
+void Log::UringFileWriter::open(const std::filesystem::path& logFilePath)
+{
+
+}
+
+void Log::UringFileWriter::append(std::string_view data)
+{
+
+}
+
+void Log::UringFileWriter::flush()
+{
+
+}
+
+Log::UringFileWriter::~UringFileWriter()
+{
+
+}
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Log.h"
+
+#include <array>
+
+// Android defines __LINUX__ too, but blocks io_uring system calls
+#if defined(__LINUX__) && !defined(__ANDROID__) && __has_include(<linux/io_uring.h>)
+#define LOG_URING
+#endif
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief Log file backend that submits full buffers through io_uring and keeps several of them in flight. Linux only, constructor throws without LOG_URING
+ */
+class Log::UringFileWriter
+{
+private:
+	static inline constexpr size_t bufferAlignment = 4096;
+	static inline constexpr size_t buffersCount = 4;
+
+	struct Buffer
+	{
+		char* data;
+		size_t size;
+		uint64_t offset;
+		bool inFlight;
+	};
+
+private:
+	int ringDescriptor;
+	void* submissionRing;
+	size_t submissionRingSize;
+	void* completionRing;
+	size_t completionRingSize;
+	io_uring_sqe* submissionEntries;
+	size_t submissionEntriesSize;
+	unsigned* submissionTail;
+	unsigned* submissionMask;
+	unsigned* submissionArray;
+	unsigned* completionHead;
+	unsigned* completionTail;
+	unsigned* completionMask;
+	io_uring_cqe* completionEntries;
+	std::array<Buffer, buffersCount> buffers;
+	size_t capacity;
+	size_t current;
+	uint64_t fileOffset;
+	int descriptor;
+
+private:
+	void submit(Buffer& buffer);
+
+	void reap(unsigned minimum);
+
+	void waitBuffer(Buffer& buffer);
+
+	void writeSynchronously(const char* data, size_t size, uint64_t offset);
+
+	void release();
+
+public:
+	/**
+	 * @param capacity Size of each buffer in bytes, rounded up to alignment
+	 * @exception std::runtime_error io_uring or its write operation is not available
+	 */
+	UringFileWriter(size_t capacity);
+
+	/**
+	 * @brief Write buffered records and open logFilePath for appending
+	 */
+	void open(const std::filesystem::path& logFilePath);
+
+	/**
+	 * @brief Buffer record and line break. Submits buffer when it is full and switches to next free buffer
+	 */
+	void append(std::string_view data);
+
+	/**
+	 * @brief Wait until all submitted writes complete and write buffered records
+	 */
+	void flush();
+
+	~UringFileWriter();
+};